@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 
 #include "alphabetparameters.h"
@@ -103,8 +104,10 @@ void String::counts(const LongLetterString &letterString, char *countsArray)
 
 ////////////
 
+static std::atomic<unsigned int> lastGeneration(0);
+
 AlphabetParameters::AlphabetParameters()
-	: m_length(0)
+	: m_length(0), m_generation(0)
 {
 	setAlphabet(emptyAlphabet());
 }
@@ -113,6 +116,7 @@ void AlphabetParameters::setAlphabet(const Alphabet &alphabet)
 {
 	m_alphabet = alphabet;
 	updateLength();
+	updateGeneration();
 
 	const Alphabet::const_iterator alphabetEnd(m_alphabet.end());
 	Alphabet::const_iterator alphabetIt;
@@ -134,6 +138,7 @@ void AlphabetParameters::setLetterParameter(Letter letter, const LetterParameter
 
 	m_alphabet[letter] = letterParameter;
 	m_letterLookup[letterParameter.text()] = letter;
+	updateGeneration();
 }
 
 void AlphabetParameters::updateLength()
@@ -141,6 +146,11 @@ void AlphabetParameters::updateLength()
 	m_length = m_alphabet.size() - QUACKLE_FIRST_LETTER;
 }
 
+void AlphabetParameters::updateGeneration()
+{
+	m_generation = ++lastGeneration;
+}
+
 Alphabet AlphabetParameters::emptyAlphabet()
 {
 	Alphabet ret(QUACKLE_FIRST_LETTER);
@@ -155,11 +165,13 @@ Alphabet AlphabetParameters::emptyAlphabet()
 void AlphabetParameters::setCount(Letter letter, int count)
 {
 	m_alphabet[letter].setCount(count);
+	updateGeneration();
 }
 
 void AlphabetParameters::setScore(Letter letter, int score)
 {
 	m_alphabet[letter].setScore(score);
+	updateGeneration();
 }
 
 LetterString AlphabetParameters::clearBlankness(const LetterString &letterString) const
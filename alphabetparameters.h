@@ -282,6 +282,11 @@ public:
 	string alphabetName() const;
 	void setAlphabetName(const string &name);
 
+	// changes whenever letters are set on any instance, so that
+	// caches of values that depend on the alphabet can tell when to
+	// refresh without trusting its address
+	unsigned int generation() const;
+
 	// finds a file in the alphabets data directory
 	static string findAlphabetFile(const string &alphabet);
 
@@ -294,8 +299,17 @@ protected:
 	LetterLookupMap m_letterLookup;
 
 	string m_alphabetName;
+	unsigned int m_generation;
+
+	// gives this alphabet a generation no other has had
+	void updateGeneration();
 };
 
+inline unsigned int AlphabetParameters::generation() const
+{
+	return m_generation;
+}
+
 inline int AlphabetParameters::length() const
 {
 	return m_length;
@@ -36,23 +36,27 @@ Bag::Bag()
 
 Bag::Bag(const LetterString &contents)
 {
+	clear();
 	toss(contents);
 }
 
 void Bag::clear()
 {
-	m_tiles.clear();
+	fill(m_counts, m_counts + QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE, 0);
+	m_size = 0;
 }
 
 void Bag::prepareFullBag()
 {
 	// put stuff in here to fill the bag
-	m_tiles.clear();
+	clear();
 
 	// we start at 0 because we want to include blanks etcetera
 	for (Letter letter = 0; letter <= QUACKLE_ALPHABET_PARAMETERS->lastLetter(); ++letter)
-		for (int i = 0; i < QUACKLE_ALPHABET_PARAMETERS->count(letter); ++i)
-			m_tiles.push_back(letter);
+	{
+		m_counts[letter] = QUACKLE_ALPHABET_PARAMETERS->count(letter);
+		m_size += m_counts[letter];
+	}
 }
 
 int Bag::fullBagTileCount()
@@ -68,26 +72,28 @@ void Bag::toss(const LetterString &letters)
 {
 	const LetterString::const_iterator end(letters.end());
 	for (LetterString::const_iterator it = letters.begin(); it != end; ++it)
-		m_tiles.push_back(*it);
+		++m_counts[(int)*it];
+	m_size += letters.length();
 }
 
 void Bag::toss(const LongLetterString &letters)
 {
 	const LongLetterString::const_iterator end(letters.end());
 	for (LongLetterString::const_iterator it = letters.begin(); it != end; ++it)
-		m_tiles.push_back(*it);
+		++m_counts[(int)*it];
+	m_size += letters.length();
 }
 
 Letter Bag::erase(int pos)
 {
-	LongLetterString::iterator it = m_tiles.begin();
-
-	for (int i = 0; i < pos; ++it, ++i) ;
+	Letter letter = 0;
+	while (pos >= m_counts[letter])
+		pos -= m_counts[letter++];
 
-	Letter ret = *it;
-	m_tiles.erase(it);
+	--m_counts[letter];
+	--m_size;
 
-	return ret;
+	return letter;
 }
 
 void Bag::exch(const Move &move, Rack &rack)
@@ -101,7 +107,7 @@ void Bag::exch(const Move &move, Rack &rack)
 
 Letter Bag::pluck()
 {
-	return erase(DataManager::self()->randomNumber() % m_tiles.size());
+	return erase(DataManager::self()->randomNumber(m_size));
 }
 
 bool Bag::removeLetters(const LetterString &letters)
@@ -130,63 +136,93 @@ bool Bag::removeLetters(const LongLetterString &letters)
 
 void Bag::letterCounts(char *countsArray) const
 {
-	String::counts(m_tiles, countsArray);
+	for (int j = 0; j < QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE; j++)
+		countsArray[j] = m_counts[j];
 }
 
 bool Bag::removeLetter(Letter letter)
 {
-	LongLetterString::iterator it;
-	const LongLetterString::iterator end(m_tiles.end());
-	for (it = m_tiles.begin(); it != end; ++it)
-		if (*it == letter)
-			break;
-
-	if (it == m_tiles.end())
+	if (letter >= QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE || m_counts[letter] == 0)
 		return false;
 
-	m_tiles.erase(it);
+	--m_counts[letter];
+	--m_size;
 	return true;
 }
 
 void Bag::refill(Rack &rack)
 {
-	for (int number = QUACKLE_PARAMETERS->rackSize() - rack.tiles().length(); number > 0 && !m_tiles.empty(); --number)
-		rack.setTiles(String::alphabetize(rack.tiles() + pluck()));
+	LetterString drawn;
+	for (int number = QUACKLE_PARAMETERS->rackSize() - rack.tiles().length(); number > 0 && m_size > 0; --number)
+		drawn.push_back(pluck());
+
+	// alphabetize once the rack is full
+	if (!drawn.empty())
+		rack.setTiles(String::alphabetize(rack.tiles() + drawn));
 }
 
 LetterString Bag::refill(Rack &rack, const LetterString &drawingOrder)
 {
 	LetterString ret(drawingOrder);
+	LetterString drawn;
 
-	for (int number = QUACKLE_PARAMETERS->rackSize() - rack.tiles().length(); number > 0 && !m_tiles.empty(); --number)
+	for (int number = QUACKLE_PARAMETERS->rackSize() - rack.tiles().length(); number > 0 && m_size > 0; --number)
 	{
 		if (drawingOrder.empty())
-			rack.setTiles(String::alphabetize(rack.tiles() + pluck()));
+			drawn.push_back(pluck());
 		else
 		{
 			removeLetter(String::back(ret));
-			rack.setTiles(String::alphabetize(rack.tiles() + String::back(ret)));
+			drawn.push_back(String::back(ret));
 			String::pop_back(ret);
 		}
 	}
 
+	if (!drawn.empty())
+		rack.setTiles(String::alphabetize(rack.tiles() + drawn));
+
 	return ret;
 }
 
+LongLetterString Bag::tiles() const
+{
+	LongLetterString ret(m_size, QUACKLE_NULL_MARK);
+
+	LongLetterString::iterator it = ret.begin();
+	for (int letter = 0; letter < QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE; ++letter)
+		it = fill_n(it, m_counts[letter], letter);
+
+	return ret;
+}
+
+// Shuffles the first count tiles into a uniformly random selection
+// of all of them. Draws through randomNumber so that threads with
+// their own random streams shuffle reproducibly.
+static void shuffleFront(LongLetterString &tiles, int count)
+{
+	const int size = tiles.size();
+	for (int i = 0; i < count && i < size - 1; ++i)
+		swap(tiles[i], tiles[i + DataManager::self()->randomNumber(size - i)]);
+}
+
 LongLetterString Bag::shuffledTiles() const
 {
-	LongLetterString ret(m_tiles);
-	random_shuffle(ret.begin(), ret.end());
+	LongLetterString ret(tiles());
+	shuffleFront(ret, ret.size());
 	return ret;
 }
 
 LetterString Bag::someShuffledTiles() const
 {
-	LongLetterString shuffled(shuffledTiles());
+	// only as many tiles as fit in the result need shuffling
+	const int count = min(m_size, LETTER_STRING_MAXIMUM_LENGTH - 1);
+
+	LongLetterString shuffled(tiles());
+	shuffleFront(shuffled, count);
+
 	LetterString ret;
-	int i = 0;
-	for (LongLetterString::const_iterator it = shuffled.begin(); it != shuffled.end() && i < LETTER_STRING_MAXIMUM_LENGTH - 1; ++it, ++i)
-		ret.push_back(*it);
+	for (int i = 0; i < count; ++i)
+		ret.push_back(shuffled[i]);
 
 	return ret;
 }
@@ -255,7 +291,7 @@ double Bag::probabilityOfDrawingFromFullBag(const LetterString &letters)
 double Bag::probabilityOfDrawingFromBag(const LetterString &letters, const Bag &bag)
 {
 	char bagCounts[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE];
-	String::counts(bag.tiles(), bagCounts);
+	bag.letterCounts(bagCounts);
 
 	char counts[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE];
 	String::counts(String::clearBlankness(letters), counts);
@@ -279,9 +315,7 @@ UVString Bag::toString() const
 {
 	UVString ret;
 
-	LongLetterString sortedLetters = m_tiles;
-	sort(sortedLetters.begin(), sortedLetters.end());
-
+	const LongLetterString sortedLetters = tiles();
 	const LongLetterString::const_iterator end(sortedLetters.end());
 	for (LongLetterString::const_iterator it = sortedLetters.begin(); it != end; ++it)
 		ret += QUACKLE_ALPHABET_PARAMETERS->userVisible(*it);
@@ -81,8 +81,9 @@ public:
 	// returns number of tiles left in the bag
 	int size() const;
 
-	const LongLetterString &tiles() const;
-	
+	// returns our tiles in alphabetical order
+	LongLetterString tiles() const;
+
 	// returns our tiles in a random order
 	LongLetterString shuffledTiles() const;
 
@@ -97,10 +98,15 @@ public:
 	UVString toString() const;
 
 private:
-	// remove letter from the bag
+	// remove and return the tile at pos, counting tiles in
+	// alphabetical order
 	Letter erase(int pos);
 
-	LongLetterString m_tiles;
+	// how many of each letter the bag holds, and how many tiles
+	// that makes, so that drawing and removing need not search
+	// through the tiles
+	int m_counts[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE];
+	int m_size;
 };
 
 inline void Bag::toss(const Rack &rack)
@@ -110,17 +116,12 @@ inline void Bag::toss(const Rack &rack)
 
 inline bool Bag::empty() const
 {
-    return m_tiles.empty();
+	return m_size == 0;
 }
 
 inline int Bag::size() const
 {
-    return m_tiles.size();
-}
-
-inline const LongLetterString &Bag::tiles() const
-{
-	return m_tiles;
+	return m_size;
 }
 
 }
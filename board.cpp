@@ -44,11 +44,13 @@ Board::Board()
       m_height(QUACKLE_BOARD_PARAMETERS->height()), 
       m_empty(true)
 {
+	allocate();
 }
 
 Board::Board(int width, int height)
     : m_width(width), m_height(height), m_empty(true)
 {
+	allocate();
 }
 
 Bag Board::tilesOnBoard() const
@@ -60,10 +62,10 @@ Bag Board::tilesOnBoard() const
 	{
 		for (int col = 0; col < m_width; col++)
 		{
-			if (m_letters[row][col] != QUACKLE_NULL_MARK)
+			if (letter(row, col) != QUACKLE_NULL_MARK)
 			{
 				LetterString letters;
-				letters += m_isBlank[row][col]? QUACKLE_BLANK_MARK : m_letters[row][col];
+				letters += isBlank(row, col)? QUACKLE_BLANK_MARK : letter(row, col);
 				ret.toss(letters);
 			}
 		}
@@ -78,8 +80,8 @@ Bag Board::tilesNotOnBoard() const
 
 	for (int row = 0; row < m_height; row++)
 		for (int col = 0; col < m_width; col++)
-			if (m_letters[row][col] != QUACKLE_NULL_MARK)
-				ret.removeLetter(m_isBlank[row][col]? QUACKLE_BLANK_MARK : m_letters[row][col]);
+			if (letter(row, col) != QUACKLE_NULL_MARK)
+				ret.removeLetter(isBlank(row, col)? QUACKLE_BLANK_MARK : letter(row, col));
 
 	return ret;
 }
@@ -100,7 +102,7 @@ bool Board::isConnected(const Move &move) const
 			const int row = move.horizontal? move.startrow : i + move.startrow;
 			const int column = move.horizontal? i + move.startcol : move.startcol;
 
-			if (isNonempty(row, column) || (row > 0 && isNonempty(row - 1, column)) || (column > 0 && isNonempty(row, column - 1)) || (row < m_height - 1 && isNonempty(row + 1, column)) || (column < m_width - 1 && isNonempty(row, column + 1)))
+			if (isOccupied(row, column) || (row > 0 && isOccupied(row - 1, column)) || (column > 0 && isOccupied(row, column - 1)) || (row < m_height - 1 && isOccupied(row + 1, column)) || (column < m_width - 1 && isOccupied(row, column + 1)))
 				return true;
 		}
 	}
@@ -141,25 +143,25 @@ void Board::updateBritishness()
 		{
 			bool isBritish = false;
 
-			if (m_letters[row][col] != QUACKLE_NULL_MARK)
+			if (letter(row, col) != QUACKLE_NULL_MARK)
 			{
 				word.clear();
-				word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[row][col]);
+				word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(row, col));
 
 				for (int j = row - 1; j >= 0; --j)
 				{
-					if (m_letters[j][col] == QUACKLE_NULL_MARK)
+					if (letter(j, col) == QUACKLE_NULL_MARK)
 						break;
 					else
-						word = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[j][col]) + word;
+						word = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(j, col)) + word;
 				}
 
 				for (int j = row + 1; j < m_height; ++j)
 				{
-					if (m_letters[j][col] == QUACKLE_NULL_MARK)
+					if (letter(j, col) == QUACKLE_NULL_MARK)
 						break;
 					else
-						word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[j][col]);
+						word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(j, col));
 				}
 
 				if (word.length() > 1)
@@ -173,22 +175,22 @@ void Board::updateBritishness()
 				}
 
 				word.clear();
-				word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[row][col]);
+				word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(row, col));
 
 				for (int j = col - 1; j >= 0; --j)
 				{
-					if (m_letters[row][j] == QUACKLE_NULL_MARK)
+					if (letter(row, j) == QUACKLE_NULL_MARK)
 						break;
 					else
-						word = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[row][j]) + word;
+						word = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(row, j)) + word;
 				}
 
 				for (int j = col + 1; j < m_width; ++j)
 				{
-					if (m_letters[row][j] == QUACKLE_NULL_MARK)
+					if (letter(row, j) == QUACKLE_NULL_MARK)
 						break;
 					else
-						word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[row][j]);
+						word += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(row, j));
 				}
 
 				if (word.length() > 1)
@@ -202,7 +204,10 @@ void Board::updateBritishness()
 				}
 			}
 
-			m_isBritish[row][col] = isBritish;
+			if (isBritish)
+				rowBritishBits(row) |= 1ULL << col;
+			else
+				rowBritishBits(row) &= ~(1ULL << col);
 		}
 	}
 }
@@ -230,7 +235,7 @@ MoveList Board::allWordsFormedBy(const Move &move) const
 				const LetterString::const_iterator end(move.tiles().end());
 				for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it, ++i)
 				{
-					if (m_letters[move.startrow][i + move.startcol] == QUACKLE_NULL_MARK)
+					if (letter(move.startrow, i + move.startcol) == QUACKLE_NULL_MARK)
 					{
 						word.clear();
 						word += *it;
@@ -238,23 +243,23 @@ MoveList Board::allWordsFormedBy(const Move &move) const
 						int startRow = 0;
 						for (int j = move.startrow - 1; j >= 0; --j)
 						{
-							if (m_letters[j][i + move.startcol] == QUACKLE_NULL_MARK)
+							if (letter(j, i + move.startcol) == QUACKLE_NULL_MARK)
 							{
 								startRow = j + 1;
 								break;
 							}
 							else
 							{
-								word = m_letters[j][i + move.startcol] + word;
+								word = letter(j, i + move.startcol) + word;
 							}
 						}
 
 						for (int j = move.startrow + 1; j < m_height; ++j)
 						{
-							if (m_letters[j][i + move.startcol] == QUACKLE_NULL_MARK)
+							if (letter(j, i + move.startcol) == QUACKLE_NULL_MARK)
 								j = m_height;
 							else
-								word += m_letters[j][i + move.startcol];
+								word += letter(j, i + move.startcol);
 						}
 
 						if (word.length() > 1)
@@ -270,7 +275,7 @@ MoveList Board::allWordsFormedBy(const Move &move) const
 				const LetterString::const_iterator end(move.tiles().end());
 				for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it, ++i)
 				{
-					if (m_letters[i + move.startrow][move.startcol] == QUACKLE_NULL_MARK)
+					if (letter(i + move.startrow, move.startcol) == QUACKLE_NULL_MARK)
 					{
 						word.clear();
 						word += *it;
@@ -278,23 +283,23 @@ MoveList Board::allWordsFormedBy(const Move &move) const
 						int startColumn = 0;
 						for (int j = move.startcol - 1; j >= 0; --j)
 						{
-							if (m_letters[i + move.startrow][j] == QUACKLE_NULL_MARK)
+							if (letter(i + move.startrow, j) == QUACKLE_NULL_MARK)
 							{
 								startColumn = j + 1;
 								break;
 							}
 							else
 							{
-								word = m_letters[i + move.startrow][j] + word;
+								word = letter(i + move.startrow, j) + word;
 							}
 						}
 
 						for (int j = move.startcol + 1; j < m_width; ++j)
 						{
-							if (m_letters[i + move.startrow][j] == QUACKLE_NULL_MARK)
+							if (letter(i + move.startrow, j) == QUACKLE_NULL_MARK)
 								j = m_width;
 							else
-								word += m_letters[i + move.startrow][j];
+								word += letter(i + move.startrow, j);
 						}
 
 						if (word.length() > 1)
@@ -322,150 +327,121 @@ int Board::score(const Move &move, bool *isBingo) const
 	if (isBingo != 0)
 		*isBingo = false;
 
-	if (move.action == Move::Place)
-	{
-		int total;
-		int laid = 0;
-		int mainscore = 0;
-		int hookscore = 0;
-		int wordmult = 1;
+	// other plays have score of zero
+	if (move.action != Move::Place)
+		return 0;
 
-		if (move.horizontal)
-		{
-			int i = 0;
-			const LetterString::const_iterator end(move.tiles().end());
-			for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it, ++i)
-			{
-				if (m_letters[move.startrow][i + move.startcol] == QUACKLE_NULL_MARK)
-				{
-					if (QUACKLE_ALPHABET_PARAMETERS->isPlainLetter(*it))
-						mainscore += QUACKLE_ALPHABET_PARAMETERS->score(*it) * letterMultiplier(move.startrow, i + move.startcol);
+	ScoringLine line;
+	const int index = move.horizontal? move.startrow : move.startcol;
+	const int start = move.horizontal? move.startcol : move.startrow;
+	loadScoringLine(line, move.horizontal, index, start, start + move.tiles().length() - 1);
+	return scoreOnLine(line, move, isBingo);
+}
 
-					++laid;
+void Board::scoreMoves(Move *moves, int count) const
+{
+	ScoringLine line;
+	bool loaded = false;
 
-					wordmult *= wordMultiplier(move.startrow, i + move.startcol);
+	for (int i = 0; i < count; ++i)
+	{
+		Move &move = moves[i];
 
-					int thishook = 0;
-					int hooked = 0;
+		if (move.action != Move::Place)
+		{
+			move.score = score(move, &move.isBingo);
+			continue;
+		}
 
-					for (int j = move.startrow - 1; j >= 0; --j)
-					{
-						if (m_letters[j][i + move.startcol] == QUACKLE_NULL_MARK)
-							j = -1;
-						else
-						{
-							++hooked;
+		const int index = move.horizontal? move.startrow : move.startcol;
+		if (!loaded || line.horizontal != move.horizontal || line.index != index)
+		{
+			loadScoringLine(line, move.horizontal, index, 0, QUACKLE_MAXIMUM_BOARD_SIZE - 1);
+			loaded = true;
+		}
 
-							if (!m_isBlank[j][i + move.startcol])
-								thishook += QUACKLE_ALPHABET_PARAMETERS->score(m_letters[j][i + move.startcol]);
-						}
-					}
+		move.score = scoreOnLine(line, move, &move.isBingo);
+	}
+}
 
-					for (int j = move.startrow + 1; j < m_height; ++j)
-					{
-						if (m_letters[j][i + move.startcol] == QUACKLE_NULL_MARK)
-							j = m_height;
-						else
-						{
-							++hooked;
+void Board::loadScoringLine(ScoringLine &line, bool horizontal, int index, int from, int to) const
+{
+	const BoardParameters *parameters = QUACKLE_BOARD_PARAMETERS;
+	const AlphabetParameters *alphabet = QUACKLE_ALPHABET_PARAMETERS;
 
-							if (!m_isBlank[j][i + move.startcol])
-								thishook += QUACKLE_ALPHABET_PARAMETERS->score(m_letters[j][i + move.startcol]);
-						}
-					}
+	line.horizontal = horizontal;
+	line.index = index;
+	line.length = horizontal? m_width : m_height;
+	line.tiles = horizontal? rowTiles(index) : columnTiles(index);
 
-					if (hooked > 0)
-					{
-						if (QUACKLE_ALPHABET_PARAMETERS->isPlainLetter(*it))
-							thishook += QUACKLE_ALPHABET_PARAMETERS->score(*it) * letterMultiplier(move.startrow, i + move.startcol);
+	if (from < 0)
+		from = 0;
+	if (to >= line.length)
+		to = line.length - 1;
 
-						thishook *= wordMultiplier(move.startrow, i + move.startcol);
-						hookscore += thishook;
-					} 
-				}
-				else if (!m_isBlank[move.startrow][i + move.startcol])
-					mainscore += QUACKLE_ALPHABET_PARAMETERS->score(m_letters[move.startrow][i + move.startcol]);
-			}
-		}
-		else
-		{
-			int i = 0;
-			const LetterString::const_iterator end(move.tiles().end());
-			for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it, ++i)
-			{
-				if (m_letters[i + move.startrow][move.startcol] == QUACKLE_NULL_MARK)
-				{
-					if (QUACKLE_ALPHABET_PARAMETERS->isPlainLetter(*it))
-						mainscore += QUACKLE_ALPHABET_PARAMETERS->score(*it) * letterMultiplier(i + move.startrow, move.startcol);
+	for (int i = from; i <= to; ++i)
+	{
+		const int row = horizontal? index : i;
+		const int col = horizontal? i : index;
 
-					++laid;
+		line.letterMultipliers[i] = parameters->letterMultiplier(row, col);
+		line.wordMultipliers[i] = parameters->wordMultiplier(row, col);
+		line.crossScores[i] = horizontal? vcrossScore(row, col) : hcrossScore(row, col);
+		line.tileScores[i] = isOccupied(row, col) && !isBlank(row, col)? alphabet->score(letter(row, col)) : 0;
+	}
+}
 
-					wordmult *= wordMultiplier(i + move.startrow, move.startcol);
+int Board::scoreOnLine(const ScoringLine &line, const Move &move, bool *isBingo) const
+{
+	const AlphabetParameters *alphabet = QUACKLE_ALPHABET_PARAMETERS;
 
-					int thishook = 0;
-					int hooked = 0;
+	int total;
+	int laid = 0;
+	int mainscore = 0;
+	int hookscore = 0;
+	int wordmult = 1;
 
-					for (int j = move.startcol - 1; j >= 0; --j)
-					{
-						if (m_letters[i + move.startrow][j] == QUACKLE_NULL_MARK)
-							j = -1;
-						else
-						{
-							++hooked;
+	int i = move.horizontal? move.startcol : move.startrow;
+	const LetterString::const_iterator end(move.tiles().end());
+	for (LetterString::const_iterator it = move.tiles().begin(); it != end && i < line.length; ++it, ++i)
+	{
+		if ((line.tiles >> i) & 1)
+		{
+			mainscore += line.tileScores[i];
+			continue;
+		}
 
-							if (!m_isBlank[i + move.startrow][j])
-								thishook += QUACKLE_ALPHABET_PARAMETERS->score(m_letters[i + move.startrow][j]);
-						}
-					}
+		const int tileScore = alphabet->isPlainLetter(*it)? alphabet->score(*it) * line.letterMultipliers[i] : 0;
 
-					for (int j = move.startcol + 1; j < m_width; ++j)
-					{
-						if (m_letters[i + move.startrow][j] == QUACKLE_NULL_MARK)
-							j = m_width;
-						else
-						{
-							++hooked;
+		++laid;
+		mainscore += tileScore;
+		wordmult *= line.wordMultipliers[i];
 
-							if (!m_isBlank[i + move.startrow][j])
-								thishook += QUACKLE_ALPHABET_PARAMETERS->score(m_letters[i + move.startrow][j]);
-						}
-					}
+		// the word formed across the play, if there is one
+		if (line.crossScores[i] >= 0)
+			hookscore += (line.crossScores[i] + tileScore) * line.wordMultipliers[i];
+	}
 
-					if (hooked > 0)
-					{
-						if (QUACKLE_ALPHABET_PARAMETERS->isPlainLetter(*it))
-							thishook += QUACKLE_ALPHABET_PARAMETERS->score(*it) * letterMultiplier(i + move.startrow, move.startcol);
+	total = hookscore;
 
-						thishook *= wordMultiplier(i + move.startrow, move.startcol);
-						hookscore += thishook;
-					}
-				}
-				else if (!m_isBlank[i + move.startrow][move.startcol])
-					mainscore += QUACKLE_ALPHABET_PARAMETERS->score(m_letters[i + move.startrow][move.startcol]);
-			}
-		}
-
-		total = hookscore;
+	if (move.tiles().length() > 1)
+		total += mainscore * wordmult;
 
-		if (move.tiles().length() > 1)
-			total += mainscore * wordmult;
+	if (isBingo != 0)
+		*isBingo = false;
 
-		if (laid == QUACKLE_PARAMETERS->rackSize())
-		{
-			if (isBingo != 0)
-				*isBingo = true;
-			total += QUACKLE_PARAMETERS->bingoBonus();
-		}
+	if (laid == QUACKLE_PARAMETERS->rackSize())
+	{
+		if (isBingo != 0)
+			*isBingo = true;
+		total += QUACKLE_PARAMETERS->bingoBonus();
+	}
 
 #ifdef DEBUG_BOARD
-		UVcout << "scoring " << move << " as " << total << "; mainscore: " << mainscore << " wordmult: " << wordmult << " hookscore: " << hookscore << " laid: " << laid << endl;
+	UVcout << "scoring " << move << " as " << total << "; mainscore: " << mainscore << " wordmult: " << wordmult << " hookscore: " << hookscore << " laid: " << laid << endl;
 #endif
 
-		return total;
-	}
-
-	// other plays have score of zero
-	return 0;
+	return total;
 }
 
 LetterString Board::prettyTilesOfMove(const Move &move, bool markPlayThruTiles) const
@@ -494,7 +470,7 @@ LetterString Board::prettyTilesOfMove(const Move &move, bool markPlayThruTiles)
 				insidePlayThru = true;
 			}
 
-			ret += m_letters[currentTileRow][currentTileCol];
+			ret += letter(currentTileRow, currentTileCol);
 		}
 		else 
 		{
@@ -536,7 +512,7 @@ LetterString Board::sanitizedTilesOfMove(const Move &move) const
 			else
 				currentTileRow += i;
 
-			if (m_letters[currentTileRow][currentTileCol] == QUACKLE_NULL_MARK)
+			if (letter(currentTileRow, currentTileCol) == QUACKLE_NULL_MARK)
 				ret += *it;
 			else
 				ret += QUACKLE_PLAYED_THRU_MARK;
@@ -545,8 +521,15 @@ LetterString Board::sanitizedTilesOfMove(const Move &move) const
 	return ret;
 }
 
-void Board::makeMove(const Move &move)
+void Board::makeMove(const Move &move, BoardUndo *undo)
 {
+	if (undo)
+	{
+		undo->wasEmpty = m_empty;
+		undo->placedCount = 0;
+		undo->crossCount = 0;
+	}
+
 	if (move.action == Move::Place)
 	{
 		m_empty = false;
@@ -556,10 +539,15 @@ void Board::makeMove(const Move &move)
 		const LetterString::const_iterator end(move.tiles().end());
 		for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it)
 		{
-			if (m_letters[row][col] == QUACKLE_NULL_MARK)
+			if (letter(row, col) == QUACKLE_NULL_MARK)
 			{
-				m_letters[row][col] = *it;
-				m_isBlank[row][col] = QUACKLE_ALPHABET_PARAMETERS->isBlankLetter(*it);
+				placeTile(row, col, *it);
+
+				if (undo)
+				{
+					undo->placedRows[undo->placedCount] = row;
+					undo->placedColumns[undo->placedCount++] = col;
+				}
 			}
 
 			if (move.horizontal)
@@ -570,6 +558,25 @@ void Board::makeMove(const Move &move)
 	}
 }
 
+void Board::unmakeMove(const BoardUndo &undo)
+{
+	// restore crosses last to first in case one was saved twice
+	for (int i = undo.crossCount - 1; i >= 0; --i)
+	{
+		if (undo.crossIsVertical[i])
+			setVCross(undo.crossRows[i], undo.crossColumns[i], undo.crosses[i]);
+		else
+			setHCross(undo.crossRows[i], undo.crossColumns[i], undo.crosses[i]);
+	}
+
+	for (int i = 0; i < undo.placedCount; ++i)
+	{
+		removeTile(undo.placedRows[i], undo.placedColumns[i]);
+	}
+
+	m_empty = undo.wasEmpty;
+}
+
 UVString Board::toString() const
 {
 	UVOStringStream ss;
@@ -595,9 +602,9 @@ UVString Board::toString() const
 
 		for (int col = 0; col < m_width; col++)
 		{
-			if (m_letters[row][col] != QUACKLE_NULL_MARK)
+			if (letter(row, col) != QUACKLE_NULL_MARK)
 			{
-				ss << QUACKLE_ALPHABET_PARAMETERS->userVisible(m_letters[row][col]);
+				ss << QUACKLE_ALPHABET_PARAMETERS->userVisible(letter(row, col));
 			}
 			else
 			{
@@ -674,15 +681,15 @@ UVString Board::htmlBoard(const int tileSize) const
 				bgcolor = "goldenrod";
 
 			ss << "<td height=" << tdHeight << " width=" << tdWidth << " bgcolor=\"" << bgcolor << "\" " << centerAlign << ">";
-			if (m_letters[row][col] != QUACKLE_NULL_MARK)
+			if (letter(row, col) != QUACKLE_NULL_MARK)
 			{
 				const int fontSize = static_cast<int>(tileSize * 5/9);
-				if (QUACKLE_ALPHABET_PARAMETERS->isBlankLetter(m_letters[row][col]))
+				if (QUACKLE_ALPHABET_PARAMETERS->isBlankLetter(letter(row, col)))
 				{
 					const int blankFontSize = static_cast<int>(fontSize * 0.8);
 					ss << "<table style=\"border: 1pt; border-style: dashed\"><tr><td width=" << tdWidth * 0.8 << " height=" << tdHeight * 0.8 << " bgcolor=\"" << bgcolor << "\" " << centerAlign << ">";
 					ss << "<span style=\"font-size: " << blankFontSize << "px\">";
-					ss << QUACKLE_ALPHABET_PARAMETERS->userVisible(QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[row][col]));
+					ss << QUACKLE_ALPHABET_PARAMETERS->userVisible(QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(row, col)));
 					ss << "</span>";
 					ss << "</td></tr></table>";
 				}
@@ -692,10 +699,10 @@ UVString Board::htmlBoard(const int tileSize) const
 					const int minimumValueFontSize = 7;
 					const int valueFontSize = minimumValueFontSize > idealValueFontSize? minimumValueFontSize : idealValueFontSize;
 					ss << "<span style=\"font-size: " << fontSize << "px\">";
-					ss << QUACKLE_ALPHABET_PARAMETERS->userVisible(m_letters[row][col]);
+					ss << QUACKLE_ALPHABET_PARAMETERS->userVisible(letter(row, col));
 					ss << "</span>";
 					ss << "<span style=\"font-size: " << valueFontSize << "px\">";
-					ss << QUACKLE_ALPHABET_PARAMETERS->score(m_letters[row][col]);
+					ss << QUACKLE_ALPHABET_PARAMETERS->score(letter(row, col));
 					ss << "</span>";
 				}
 			}
@@ -737,29 +744,110 @@ UVOStream &operator<<(UVOStream &o, const Board &board)
 void Board::prepareEmptyBoard()
 {
 	m_empty = true;
+	allocate();
+}
+
+void Board::allocate()
+{
+	m_letters.assign(m_width * m_height, QUACKLE_NULL_MARK);
+	m_vcross.assign(m_width * m_height, LetterBitset().set());
+	m_hcross.assign(m_width * m_height, LetterBitset().set());
+	m_vcrossScores.assign(m_width * m_height, -1);
+	m_hcrossScores.assign(m_width * m_height, -1);
+	m_bitboards.assign(3 * m_height + m_width, 0);
+}
+
+void Board::placeTile(int row, int col, Letter letter)
+{
+	m_letters[square(row, col)] = letter;
+	rowTilesBits(row) |= 1ULL << col;
+	columnTilesBits(col) |= 1ULL << row;
+	if (QUACKLE_ALPHABET_PARAMETERS->isBlankLetter(letter))
+		rowBlanksBits(row) |= 1ULL << col;
+
+	updateCrossScores(row, col);
+}
+
+void Board::removeTile(int row, int col)
+{
+	m_letters[square(row, col)] = QUACKLE_NULL_MARK;
+	rowTilesBits(row) &= ~(1ULL << col);
+	columnTilesBits(col) &= ~(1ULL << row);
+	rowBlanksBits(row) &= ~(1ULL << col);
+
+	updateCrossScores(row, col);
+}
+
+// Rescores the empty squares whose words across take in the square:
+// the square itself and the nearest empty square each way.
+void Board::updateCrossScores(int row, int col)
+{
+	m_vcrossScores[square(row, col)] = isOccupied(row, col)? -1 : tilesScore(row, col, true);
+	m_hcrossScores[square(row, col)] = isOccupied(row, col)? -1 : tilesScore(row, col, false);
+
+	int i = row - 1;
+	while (i >= 0 && isOccupied(i, col))
+		--i;
+	if (i >= 0)
+		m_vcrossScores[square(i, col)] = tilesScore(i, col, true);
+
+	i = row + 1;
+	while (i < m_height && isOccupied(i, col))
+		++i;
+	if (i < m_height)
+		m_vcrossScores[square(i, col)] = tilesScore(i, col, true);
+
+	i = col - 1;
+	while (i >= 0 && isOccupied(row, i))
+		--i;
+	if (i >= 0)
+		m_hcrossScores[square(row, i)] = tilesScore(row, i, false);
+
+	i = col + 1;
+	while (i < m_width && isOccupied(row, i))
+		++i;
+	if (i < m_width)
+		m_hcrossScores[square(row, i)] = tilesScore(row, i, false);
+}
+
+// the score of the tiles either side of an empty square, above and
+// below if vertical, or -1 if there are none
+int Board::tilesScore(int row, int col, bool vertical) const
+{
+	const AlphabetParameters *alphabet = QUACKLE_ALPHABET_PARAMETERS;
+	const int rowStep = vertical? 1 : 0;
+	const int colStep = vertical? 0 : 1;
+
+	int hooked = 0;
+	int score = 0;
 
-	for (int i = 0; i < m_height; ++i)
+	for (int r = row - rowStep, c = col - colStep; r >= 0 && c >= 0 && isOccupied(r, c); r -= rowStep, c -= colStep)
 	{
-		for (int j = 0; j < m_width; ++j)
-		{
-			m_letters[i][j] = QUACKLE_NULL_MARK;
-			m_isBlank[i][j] = false;
-			m_vcross[i][j].set();
-			m_hcross[i][j].set();
-		}
+		++hooked;
+		if (!isBlank(r, c))
+			score += alphabet->score(letter(r, c));
+	}
+
+	for (int r = row + rowStep, c = col + colStep; r < m_height && c < m_width && isOccupied(r, c); r += rowStep, c += colStep)
+	{
+		++hooked;
+		if (!isBlank(r, c))
+			score += alphabet->score(letter(r, c));
 	}
+
+	return hooked > 0? score : -1;
 }
 
 Board::TileInformation Board::tileInformation(int row, int col) const
 {
 	TileInformation ret;
 
-	if (m_letters[row][col] != QUACKLE_NULL_MARK)
+	if (letter(row, col) != QUACKLE_NULL_MARK)
 	{
 		ret.tileType = LetterTile;
-		ret.isBlank = m_isBlank[row][col];
-		ret.letter = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(m_letters[row][col]);
-		ret.isBritish = m_isBritish[row][col];
+		ret.isBlank = isBlank(row, col);
+		ret.letter = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(letter(row, col));
+		ret.isBritish = isBritish(row, col);
 	}
 	else
 	{
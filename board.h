@@ -19,6 +19,7 @@
 #ifndef QUACKLE_BOARD_H
 #define QUACKLE_BOARD_H
 
+#include <cstdint>
 #include <vector>
 #include <bitset>
 
@@ -37,6 +38,25 @@ typedef bitset<QUACKLE_MAXIMUM_ALPHABET_SIZE> LetterBitset;
 namespace Quackle
 {
 
+// What a move changes on a board, saved by makeMove so that
+// Board::unmakeMove can take the move back without the board
+// having been copied
+struct BoardUndo
+{
+	bool wasEmpty;
+
+	int placedCount;
+	int placedRows[QUACKLE_MAXIMUM_BOARD_SIZE];
+	int placedColumns[QUACKLE_MAXIMUM_BOARD_SIZE];
+
+	// crosses as they were before the move regenerated them
+	int crossCount;
+	int crossRows[4 * QUACKLE_MAXIMUM_BOARD_SIZE + 4];
+	int crossColumns[4 * QUACKLE_MAXIMUM_BOARD_SIZE + 4];
+	bool crossIsVertical[4 * QUACKLE_MAXIMUM_BOARD_SIZE + 4];
+	LetterBitset crosses[4 * QUACKLE_MAXIMUM_BOARD_SIZE + 4];
+};
+
 class Board
 {
 public:
@@ -60,7 +80,13 @@ public:
 
 	bool isEmpty() const;
 
-	void makeMove(const Move &move);
+	// If undo is nonzero, the squares filled are saved in it
+	// (and its saved crosses are cleared).
+	void makeMove(const Move &move, BoardUndo *undo = 0);
+
+	// Takes back the move that undo was saved for. Moves must be
+	// taken back in the reverse of the order they were made.
+	void unmakeMove(const BoardUndo &undo);
 
 	// Returns all words formed when play is made.
 	// If move.tiles() is only of length 1, specified move is not in the 
@@ -82,6 +108,12 @@ public:
 	// is stored in isBingo.
 	int score(const Move &move, bool *isBingo = 0) const;
 
+	// Scores each of count moves as score() would, storing the score
+	// and bingo flag in the move. Consecutive moves along the same row
+	// or column share one lookup of that line's squares, so moves are
+	// best passed grouped by line.
+	void scoreMoves(Move *moves, int count) const;
+
 	// Return string suitable for prettyTiles field of move.
 	// If markPlayThruTiles is true, wrap tiles played thru in
 	// parentheses
@@ -125,25 +157,80 @@ public:
 	bool isBlank(int row, int col) const;
 	bool isBritish(int row, int col) const;
 
+	// whether there is a tile on the square
+	bool isOccupied(int row, int col) const;
+
+	// squares with tiles on them as bits, column col of a row at
+	// bit col and row row of a column at bit row
+	uint64_t rowTiles(int row) const;
+	uint64_t columnTiles(int col) const;
+
 	const LetterBitset &vcross(int row, int col) const;
 	void setVCross(int row, int col, const LetterBitset &vcross);
 
 	const LetterBitset &hcross(int row, int col) const;
 	void setHCross(int row, int col, const LetterBitset &hcross);
 
+	// sum of the scores of the tiles directly above and below an
+	// empty square, or -1 if it has none; hcrossScore likewise for
+	// the tiles left and right of it
+	int vcrossScore(int row, int col) const;
+	int hcrossScore(int row, int col) const;
+
+	// save a cross into undo before it is changed
+	void saveVCross(int row, int col, BoardUndo &undo) const;
+	void saveHCross(int row, int col, BoardUndo &undo) const;
+
 protected:
 	int m_width;
 	int m_height;
 	bool m_empty;
 
-	Letter m_letters[QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE];
-	bool m_isBlank[QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE];
-	bool m_isBritish[QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE];
+	// Squares are kept row by row in arrays sized to the board, so
+	// that copying a board copies only its own squares.
+	vector<Letter> m_letters;
+	vector<LetterBitset> m_vcross;
+	vector<LetterBitset> m_hcross;
+	vector<int> m_vcrossScores;
+	vector<int> m_hcrossScores;
+
+	// a bitboard of tiles, one of blanks and one of british words
+	// for each row, then one of tiles for each column
+	vector<uint64_t> m_bitboards;
+
+	int square(int row, int col) const;
+	uint64_t &rowTilesBits(int row);
+	uint64_t &rowBlanksBits(int row);
+	uint64_t &rowBritishBits(int row);
+	uint64_t &columnTilesBits(int col);
+
+	// sizes the arrays to the board, with no tiles and all crosses set
+	void allocate();
+
+	// placing and removing tiles keeps cross scores up to date
+	void placeTile(int row, int col, Letter letter);
+	void removeTile(int row, int col);
+	void updateCrossScores(int row, int col);
+	int tilesScore(int row, int col, bool vertical) const;
+
+	// what scoring a play needs of each square along one row or
+	// column, looked up once for all plays on the line
+	struct ScoringLine
+	{
+		bool horizontal;
+		int index;
+		int length;
+		uint64_t tiles;
+		int letterMultipliers[QUACKLE_MAXIMUM_BOARD_SIZE];
+		int wordMultipliers[QUACKLE_MAXIMUM_BOARD_SIZE];
+		int crossScores[QUACKLE_MAXIMUM_BOARD_SIZE];
+		int tileScores[QUACKLE_MAXIMUM_BOARD_SIZE];
+	};
 
-	LetterBitset m_vcross[QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE];
-	LetterBitset m_hcross[QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE];
+	// fills in squares from through to of the line
+	void loadScoringLine(ScoringLine &line, bool horizontal, int index, int from, int to) const;
+	int scoreOnLine(const ScoringLine &line, const Move &move, bool *isBingo) const;
 
-	inline bool isNonempty(int row, int column) const;
 };
 
 inline bool Board::isEmpty() const
@@ -151,44 +238,105 @@ inline bool Board::isEmpty() const
 	return m_empty;
 }
 
+inline int Board::square(int row, int col) const
+{
+	return row * m_width + col;
+}
+
+inline uint64_t &Board::rowTilesBits(int row)
+{
+	return m_bitboards[row];
+}
+
+inline uint64_t &Board::rowBlanksBits(int row)
+{
+	return m_bitboards[m_height + row];
+}
+
+inline uint64_t &Board::rowBritishBits(int row)
+{
+	return m_bitboards[2 * m_height + row];
+}
+
+inline uint64_t &Board::columnTilesBits(int col)
+{
+	return m_bitboards[3 * m_height + col];
+}
+
 inline Letter Board::letter(int row, int col) const
 {
-	return m_letters[row][col];
+	return m_letters[square(row, col)];
 }
 
 inline bool Board::isBlank(int row, int col) const
 {
-	return m_isBlank[row][col];
+	return (m_bitboards[m_height + row] >> col) & 1;
 }
 
 inline bool Board::isBritish(int row, int col) const
 {
-	return m_isBritish[row][col];
+	return (m_bitboards[2 * m_height + row] >> col) & 1;
+}
+
+inline bool Board::isOccupied(int row, int col) const
+{
+	return (m_bitboards[row] >> col) & 1;
+}
+
+inline uint64_t Board::rowTiles(int row) const
+{
+	return m_bitboards[row];
+}
+
+inline uint64_t Board::columnTiles(int col) const
+{
+	return m_bitboards[3 * m_height + col];
 }
 
 inline const LetterBitset &Board::vcross(int row, int col) const
 {
-	return m_vcross[row][col];
+	return m_vcross[square(row, col)];
 }
 
 inline void Board::setVCross(int row, int col, const LetterBitset &vcross)
 {
-	m_vcross[row][col] = vcross;
+	m_vcross[square(row, col)] = vcross;
 }
 
 inline const LetterBitset &Board::hcross(int row, int col) const
 {
-	return m_hcross[row][col];
+	return m_hcross[square(row, col)];
 }
 
 inline void Board::setHCross(int row, int col, const LetterBitset &hcross)
 {
-	m_hcross[row][col] = hcross;
+	m_hcross[square(row, col)] = hcross;
+}
+
+inline int Board::vcrossScore(int row, int col) const
+{
+	return m_vcrossScores[square(row, col)];
+}
+
+inline int Board::hcrossScore(int row, int col) const
+{
+	return m_hcrossScores[square(row, col)];
+}
+
+inline void Board::saveVCross(int row, int col, BoardUndo &undo) const
+{
+	undo.crossRows[undo.crossCount] = row;
+	undo.crossColumns[undo.crossCount] = col;
+	undo.crossIsVertical[undo.crossCount] = true;
+	undo.crosses[undo.crossCount++] = vcross(row, col);
 }
 
-inline bool Board::isNonempty(int row, int column) const
+inline void Board::saveHCross(int row, int col, BoardUndo &undo) const
 {
-	return m_letters[row][column] != QUACKLE_NULL_MARK;
+	undo.crossRows[undo.crossCount] = row;
+	undo.crossColumns[undo.crossCount] = col;
+	undo.crossIsVertical[undo.crossCount] = false;
+	undo.crosses[undo.crossCount++] = hcross(row, col);
 }
 
 }
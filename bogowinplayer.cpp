@@ -86,14 +86,16 @@ Move SmartBogowin::move()
 
 MoveList SmartBogowin::moves(int nmoves)
 {
+	DataManagerScope scope(dataManager());
 	Stopwatch stopwatch;
 	
 	if (currentPosition().bag().empty())
     {
         signalFractionDone(0);
-		EndgamePlayer endgame;
-		endgame.setPosition(currentPosition());
-		return endgame.moves(nmoves);
+		m_endgamePlayer.setParameters(m_parameters);
+		m_endgamePlayer.setDispatch(dispatch());
+		m_endgamePlayer.setPosition(currentPosition());
+		return m_endgamePlayer.moves(nmoves);
 	}
 
     // TODO
@@ -136,7 +138,7 @@ MoveList SmartBogowin::moves(int nmoves)
 
 	const int initialCandidates = m_additionalInitialCandidates + nmoves;
 	
-	currentPosition().kibitz(initialCandidates);
+	currentPosition().kibitz(initialCandidates, zerothPrune);
 	
 	m_simulator.setIncludedMoves(m_simulator.currentPosition().moves());
 	m_simulator.pruneTo(zerothPrune, initialCandidates);
@@ -149,71 +151,40 @@ MoveList SmartBogowin::moves(int nmoves)
 	//UVcout << "Bogo static moves: " << staticMoves << endl;
 	//UVcout << "Bogo considered moves: " << m_simulator.consideredMoves() << endl;
 	
-	MoveList firstMove;
-	MoveList simmedMoves;
-
-	MoveList::const_iterator it = staticMoves.begin();
-	
-	firstMove.push_back(*it);
-
 	signalFractionDone(0);
 
-	m_simulator.setIncludedMoves(firstMove);
-	m_simulator.simulate(plies, minIterations());
-	
-	Move best = *m_simulator.moves(/* prune */ true, /* sort by win */ true).begin();
-	simmedMoves.push_back(best);
-	
-	double bestbp = bogopoints(best);
-	
-	//UVcout << "firstMove: " << best << endl;
+	// Race the candidates a batch of minIterations() at a time, by
+	// win percentage, until one is clearly best, maxIterations() have
+	// run or our time is up. Candidates clearly beaten drop out of
+	// the race and stop costing iterations.
+	m_simulator.setIncludedMoves(staticMoves);
 
-	for (++it; it != staticMoves.end(); ++it)
+	for (int iterations = 0; iterations < maxIterations(); iterations += minIterations())
 	{
-		signalFractionDone(max(static_cast<float>(simmedMoves.size()) / static_cast<float>(staticMoves.size()), static_cast<float>(stopwatch.elapsed()) / static_cast<float>(m_parameters.secondsPerTurn)));
+		signalFractionDone(max(static_cast<float>(iterations) / static_cast<float>(maxIterations()), static_cast<float>(stopwatch.elapsed()) / static_cast<float>(m_parameters.secondsPerTurn)));
 
 		if (shouldAbort())
-			goto sort_and_return;
-
-		//UVcout << "best move: " << best << " with " << bestbp  << " bogopoints." << endl;
-		MoveList lookFurther;
-		lookFurther.push_back(*it);
-		m_simulator.setIncludedMoves(lookFurther);
-		m_simulator.simulate(plies, minIterations());
-		Move move = *m_simulator.moves(/* prune */ true, /* sort by win */ true).begin();
-		double movebp = bogopoints(move);
-		//UVcout << "we just simmed " << move << "; bogopoints: " << movebp << endl;
-	
-		if (movebp + 1.96 * 35.0 / sqrt((double)minIterations()) > bestbp)
-		{
-			m_simulator.simulate(plies, maxIterations() - minIterations());
-			Move move2 = *m_simulator.moves(true, true).begin();
-			movebp = bogopoints(move2);
-			//UVcout << "sim it some more: " << move2 << " bogopoints: " << movebp << endl;
-			simmedMoves.push_back(move2);
-	
-			if (move2.win > best.win) 
-			{
-				best = move2;
-				bestbp = movebp;
-			}
-		}
-		else
-		{
-			simmedMoves.push_back(move);
-		}
-		
+			break;
+
+		if (!m_simulator.race(plies, min(minIterations(), maxIterations() - iterations), /* by win */ true, minIterations()))
+			break;
+
 		if (stopwatch.exceeded(m_parameters.secondsPerTurn))
 		{
 			//UVcout << "Bogowinplayer stopwatch exceeded its limit " << m_parameters.secondsPerTurn << ". Returning early." << endl;
-			goto sort_and_return;
+			break;
 		}
-	}	
+	}
 
-	//UVcout << "We had extra time! whoopee!" << endl;
+	// candidates that dropped out keep their results, so rank
+	// all of them
+	MoveList simmedMoves;
+	const MoveList allMoves(m_simulator.moves(/* prune */ false, /* sort by win */ true));
+	const MoveList::const_iterator allEnd = allMoves.end();
+	for (MoveList::const_iterator allIt = allMoves.begin(); allIt != allEnd; ++allIt)
+		if (staticMoves.contains(*allIt))
+			simmedMoves.push_back(*allIt);
 
-	sort_and_return:
-	MoveList::sort(simmedMoves, MoveList::Win);
 	MoveList ret;
 	MoveList::const_iterator simmedEnd = simmedMoves.end();
 	int i = 0;
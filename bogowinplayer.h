@@ -20,7 +20,7 @@
 #define QUACKLE_BOGOWINPLAYER_H
 
 #include "computerplayer.h"
-#include "endgame.h"
+#include "endgameplayer.h"
 
 namespace Quackle
 {
@@ -43,7 +43,8 @@ protected:
 	int minIterations() const;
 	int maxIterations() const;
 
-	Endgame m_endgame;
+	// kept from turn to turn, as is what it solves
+	EndgamePlayer m_endgamePlayer;
 
 	int m_additionalInitialCandidates;
 	int m_minIterationsPerSecond;
@@ -16,7 +16,10 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <thread>
+
 #include "computerplayer.h"
+#include "datamanager.h"
 #include "endgameplayer.h"
 
 using namespace Quackle;
@@ -26,6 +29,15 @@ ComputerPlayer::ComputerPlayer()
 {
 	m_parameters.secondsPerTurn = 10;
     m_parameters.inferring = false;
+	m_parameters.threadCount = 0;
+}
+
+int ComputerPlayer::threadCount() const
+{
+	if (m_parameters.threadCount > 0)
+		return m_parameters.threadCount;
+
+	return max(1, static_cast<int>(thread::hardware_concurrency()));
 }
 
 ComputerPlayer::~ComputerPlayer()
@@ -85,11 +97,13 @@ StaticPlayer::~StaticPlayer()
 
 Move StaticPlayer::move()
 {
+	DataManagerScope scope(dataManager());
 	return m_simulator.currentPosition().staticBestMove();
 }
 
 MoveList StaticPlayer::moves(int nmoves)
 {
+	DataManagerScope scope(dataManager());
 	m_simulator.currentPosition().kibitz(nmoves);
 	return m_simulator.currentPosition().moves();
 }
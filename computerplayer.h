@@ -35,6 +35,9 @@ struct ComputerParameters
 
     // when simming, use likely rack leaves for opponent based on their previous play
     bool inferring;
+
+	// threads to compute on, or zero for one per core
+	int threadCount;
 };
 
 class ComputerDispatch
@@ -129,6 +132,11 @@ public:
 	// sets dispatch for this player and its simulator
 	virtual void setDispatch(ComputerDispatch *dispatch);
 
+	// Data manager that this player and its simulator run against.
+	// If unset, the one current on the calling thread is used.
+	void setDataManager(DataManager *dataManager);
+	DataManager *dataManager() const;
+
 protected:
 	// a max function for convenience
 	static double max(double v1, double v2);
@@ -138,6 +146,9 @@ protected:
 	UVString m_name;
 	int m_id;
 	ComputerParameters m_parameters;
+
+	// threads that the parameters allow, at least one
+	int threadCount() const;
 	ComputerDispatch *m_dispatch;
 };
 
@@ -186,6 +197,16 @@ inline ComputerDispatch *ComputerPlayer::dispatch() const
 	return m_dispatch;
 }
 
+inline void ComputerPlayer::setDataManager(DataManager *dataManager)
+{
+	m_simulator.setDataManager(dataManager);
+}
+
+inline DataManager *ComputerPlayer::dataManager() const
+{
+	return m_simulator.dataManager();
+}
+
 inline double ComputerPlayer::max(double v1, double v2)
 {
 	return v1 > v2? v1 : v2;
@@ -0,0 +1,123 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "alphabetparameters.h"
+#include "crosscache.h"
+#include "datamanager.h"
+
+using namespace Quackle;
+
+CrossCache::CrossCache()
+{
+}
+
+std::string CrossCache::key(const LetterString &pre, const LetterString &suf)
+{
+	// which letters fit depends on the alphabet too, so entries made
+	// under another one are never found
+	const unsigned int generation = QUACKLE_ALPHABET_PARAMETERS->generation();
+
+	// letters on the board are never the null mark, so it can
+	// separate the two
+	std::string ret;
+	ret.reserve(sizeof(generation) + pre.length() + suf.length() + 1);
+	ret.append(reinterpret_cast<const char *>(&generation), sizeof(generation));
+	ret.append(pre.begin(), pre.end());
+	ret.push_back(QUACKLE_NULL_MARK);
+	ret.append(suf.begin(), suf.end());
+	return ret;
+}
+
+CrossCache::Shard &CrossCache::shardFor(const std::string &key)
+{
+	return m_shards[std::hash<std::string>()(key) % shardCount];
+}
+
+bool CrossCache::find(const LetterString &pre, const LetterString &suf, LetterBitset &crosses)
+{
+	const std::string fragment = key(pre, suf);
+	Shard &shard = shardFor(fragment);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	std::unordered_map<std::string, LetterBitset>::const_iterator it = shard.entries.find(fragment);
+	if (it == shard.entries.end())
+	{
+		++shard.misses;
+		return false;
+	}
+
+	++shard.hits;
+	crosses = it->second;
+	return true;
+}
+
+void CrossCache::store(const LetterString &pre, const LetterString &suf, const LetterBitset &crosses)
+{
+	const std::string fragment = key(pre, suf);
+	Shard &shard = shardFor(fragment);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	if (shard.entries.size() >= maximumShardSize)
+		shard.entries.clear();
+	shard.entries[fragment] = crosses;
+}
+
+void CrossCache::clear()
+{
+	for (int i = 0; i < shardCount; ++i)
+	{
+		std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+		m_shards[i].entries.clear();
+		m_shards[i].hits = 0;
+		m_shards[i].misses = 0;
+	}
+}
+
+long long CrossCache::hits() const
+{
+	long long ret = 0;
+	for (int i = 0; i < shardCount; ++i)
+	{
+		std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+		ret += m_shards[i].hits;
+	}
+	return ret;
+}
+
+long long CrossCache::misses() const
+{
+	long long ret = 0;
+	for (int i = 0; i < shardCount; ++i)
+	{
+		std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+		ret += m_shards[i].misses;
+	}
+	return ret;
+}
+
+int CrossCache::size() const
+{
+	int ret = 0;
+	for (int i = 0; i < shardCount; ++i)
+	{
+		std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+		ret += m_shards[i].entries.size();
+	}
+	return ret;
+}
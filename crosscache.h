@@ -0,0 +1,79 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUACKLE_CROSSCACHE_H
+#define QUACKLE_CROSSCACHE_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "board.h"
+
+namespace Quackle
+{
+
+// Remembers which letters fit between a prefix and a suffix in the
+// lexicon it belongs to under the current alphabet, so that the
+// fragments boards keep sharing across a simulation have their cross
+// sets worked out once. Safe to use from several threads at once.
+class CrossCache
+{
+public:
+	CrossCache();
+
+	// returns true and sets crosses if pre_suf has been stored
+	bool find(const LetterString &pre, const LetterString &suf, LetterBitset &crosses);
+	void store(const LetterString &pre, const LetterString &suf, const LetterBitset &crosses);
+
+	// forgets all entries and resets the counters
+	void clear();
+
+	// finds that did and didn't find an entry
+	long long hits() const;
+	long long misses() const;
+
+	int size() const;
+
+private:
+	static const int shardCount = 64;
+
+	// a shard that fills up is emptied, which bounds memory at
+	// shardCount * maximumShardSize entries
+	static const size_t maximumShardSize = 4096;
+
+	struct Shard
+	{
+		Shard() : hits(0), misses(0) {}
+
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, LetterBitset> entries;
+		long long hits;
+		long long misses;
+	};
+
+	static std::string key(const LetterString &pre, const LetterString &suf);
+	Shard &shardFor(const std::string &key);
+
+	Shard m_shards[shardCount];
+};
+
+}
+
+#endif
@@ -18,7 +18,10 @@
 
 #include <time.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <cstdlib>
+#include <mutex>
+#include <vector>
 
 #include "catchall.h"
 #include "computerplayer.h"
@@ -29,6 +32,7 @@
 #include "catchall.h"
 #include "gameparameters.h"
 #include "lexiconparameters.h"
+#include "resultcache.h"
 #include "strategyparameters.h"
 
 #define QUACKLDEBUG
@@ -36,11 +40,25 @@
 using namespace Quackle;
 
 DataManager *DataManager::m_self = 0;
+thread_local DataManager *DataManager::m_threadSelf = 0;
+
+// every DataManager alive, in the order constructed, so that the
+// default can fall back to the last survivor
+static vector<DataManager *> liveDataManagers;
+static mutex liveDataManagersMutex;
+
+static thread_local bool threadHasRandomGenerator = false;
+static thread_local RandomGenerator threadRandomGenerator;
 
 DataManager::DataManager()
-	: m_evaluator(0), m_parameters(0), m_alphabetParameters(0), m_boardParameters(0), m_lexiconParameters(0), m_strategyParameters(0)
+	: m_evaluator(0), m_parameters(0), m_alphabetParameters(0), m_boardParameters(0), m_lexiconParameters(0), m_strategyParameters(0), m_resultCache(0)
 {
-	m_self = this;
+	{
+		lock_guard<mutex> lock(liveDataManagersMutex);
+		liveDataManagers.push_back(this);
+		m_self = this;
+	}
+
 	setAppDataDirectory(".");
 	setUserDataDirectory(".");
     seedRandomNumbers((int)time(NULL));
@@ -51,6 +69,7 @@ DataManager::DataManager()
 	m_boardParameters = new EnglishBoard;
 	m_lexiconParameters = new LexiconParameters;
 	m_strategyParameters = new StrategyParameters;
+	m_resultCache = new ResultCache;
 }
 
 DataManager::~DataManager()
@@ -61,8 +80,14 @@ DataManager::~DataManager()
 	delete m_boardParameters;
 	delete m_lexiconParameters;
 	delete m_strategyParameters;
+	delete m_resultCache;
 
 	cleanupComputerPlayers();
+
+	lock_guard<mutex> lock(liveDataManagersMutex);
+	liveDataManagers.erase(find(liveDataManagers.begin(), liveDataManagers.end(), this));
+	if (m_self == this)
+		m_self = liveDataManagers.empty()? 0 : liveDataManagers.back();
 }
 
 bool DataManager::isGood() const
@@ -74,36 +99,42 @@ void DataManager::setEvaluator(Evaluator *evaluator)
 {
 	delete m_evaluator;
 	m_evaluator = evaluator;
+	m_resultCache->clear();
 }
 
 void DataManager::setParameters(GameParameters *parameters)
 {
 	delete m_parameters;
 	m_parameters = parameters;
+	m_resultCache->clear();
 }
 
 void DataManager::setAlphabetParameters(AlphabetParameters *alphabetParameters)
 {
 	delete m_alphabetParameters;
 	m_alphabetParameters = alphabetParameters;
+	m_resultCache->clear();
 }
 
 void DataManager::setBoardParameters(BoardParameters *boardParameters)
 {
 	delete m_boardParameters;
 	m_boardParameters = boardParameters;
+	m_resultCache->clear();
 }
 
 void DataManager::setLexiconParameters(LexiconParameters *lexiconParameters)
 {
 	delete m_lexiconParameters;
 	m_lexiconParameters = lexiconParameters;
+	m_resultCache->clear();
 }
 
 void DataManager::setStrategyParameters(StrategyParameters *strategyParameters)
 {
 	delete m_strategyParameters;
 	m_strategyParameters = strategyParameters;
+	m_resultCache->clear();
 }
 
 void DataManager::setComputerPlayers(const PlayerList &playerList)
@@ -176,10 +207,55 @@ string DataManager::makeDataFilename(const string &subDirectory, const string &f
 
 void DataManager::seedRandomNumbers(unsigned int seed)
 {
-    srand(seed);
+	lock_guard<mutex> lock(m_randomMutex);
+	m_randomGenerator.seed(seed);
+}
+
+void DataManager::setThreadRandomGenerator(const RandomGenerator &generator)
+{
+	threadRandomGenerator = generator;
+	threadHasRandomGenerator = true;
 }
 
 int DataManager::randomNumber()
 {
-	return rand();
+	if (threadHasRandomGenerator)
+		return (int)(threadRandomGenerator.next() >> 33);
+
+	lock_guard<mutex> lock(m_randomMutex);
+	return (int)(m_randomGenerator.next() >> 33);
+}
+
+int DataManager::randomNumber(int bound)
+{
+	if (threadHasRandomGenerator)
+		return (int)threadRandomGenerator.bounded(bound);
+
+	lock_guard<mutex> lock(m_randomMutex);
+	return (int)m_randomGenerator.bounded(bound);
+}
+
+///////
+
+DataManagerScope::DataManagerScope(DataManager *dataManager)
+	: m_previous(DataManager::m_threadSelf)
+{
+	if (dataManager)
+		DataManager::m_threadSelf = dataManager;
+}
+
+DataManagerScope::~DataManagerScope()
+{
+	DataManager::m_threadSelf = m_previous;
+}
+
+RandomStreamScope::RandomStreamScope()
+	: m_hadGenerator(threadHasRandomGenerator), m_generator(threadRandomGenerator)
+{
+}
+
+RandomStreamScope::~RandomStreamScope()
+{
+	threadHasRandomGenerator = m_hadGenerator;
+	threadRandomGenerator = m_generator;
 }
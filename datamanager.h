@@ -19,9 +19,11 @@
 #ifndef QUACKLE_DATAMANAGER_H
 #define QUACKLE_DATAMANAGER_H
 
+#include <mutex>
 #include <string>
 
 #include "playerlist.h"
+#include "randomgenerator.h"
 
 using namespace std;
 
@@ -34,14 +36,17 @@ using namespace std;
 #define QUACKLE_LEXICON_PARAMETERS Quackle::DataManager::self()->lexiconParameters()
 #define QUACKLE_STRATEGY_PARAMETERS Quackle::DataManager::self()->strategyParameters()
 #define QUACKLE_COMPUTER_PLAYERS Quackle::DataManager::self()->computerPlayers()
+#define QUACKLE_RESULT_CACHE Quackle::DataManager::self()->resultCache()
 
 namespace Quackle
 {
 
-// General singleton type that will be around whenever
-// you use libquackle.
-// It provides access to lexica (todo), random numbers,
-// and all parameters for a game
+// Engine context that will be around whenever you use libquackle.
+// It provides access to lexica, random numbers, and all parameters
+// for a game. Several can coexist in one process; self() returns
+// the one made current on the calling thread by a DataManagerScope,
+// or else the process default, which is the last one constructed
+// of those still alive.
 
 class AlphabetParameters;
 class BoardParameters;
@@ -49,13 +54,14 @@ class Evaluator;
 class GameParameters;
 class LexiconParameters;
 class PlayerList;
+class ResultCache;
 class StrategyParameters;
 
 class DataManager
 {
 public:
-	// sets up singleton, seeds random number generator,
-	// and creates default parameter instances
+	// becomes the process default if there is none yet, seeds
+	// random number generator, and creates default parameter instances
 	DataManager();
 
 	~DataManager();
@@ -87,6 +93,10 @@ public:
 	StrategyParameters *strategyParameters();
 	void setStrategyParameters(StrategyParameters *strategyParameters);
 
+	// results of the calculations nested in those of computer
+	// players, kept across turns and games
+	ResultCache *resultCache();
+
 	// When the data manager dies or setComputerPlayers is called, it deletes
 	// all of the computer players pointed to by the players in this list. The
 	// players' names are the names of the computer players, and the players'
@@ -121,11 +131,27 @@ public:
 	void setUserDataDirectory(string directory) { m_userDataDirectory = directory; }
 	string userDataDirectory() { return m_userDataDirectory; }
 
+	// seeds this data manager's generator, which threads
+	// without a random stream of their own share
 	void seedRandomNumbers(unsigned int seed);
+
+	// Gives the calling thread a random stream of its own, starting
+	// from generator, until the innermost RandomStreamScope around
+	// the call ends. Threads without one draw from the shared
+	// generator.
+	void setThreadRandomGenerator(const RandomGenerator &generator);
+
+	// nonnegative random int
 	int randomNumber();
 
+	// uniform in [0, bound), without the bias of randomNumber() % bound
+	int randomNumber(int bound);
+
 private:
+	friend class DataManagerScope;
+
 	static DataManager *m_self;
+	static thread_local DataManager *m_threadSelf;
 
 	bool fileExists(const string &filename);
 
@@ -142,18 +168,52 @@ private:
 	BoardParameters *m_boardParameters;
 	LexiconParameters *m_lexiconParameters;
 	StrategyParameters *m_strategyParameters;
+	ResultCache *m_resultCache;
 
 	PlayerList m_computerPlayers;
+
+	RandomGenerator m_randomGenerator;
+	std::mutex m_randomMutex;
+};
+
+// Makes a data manager current on the calling thread until the
+// scope ends, so that QUACKLE_* parameters reached from it (and from
+// the Generator, Simulator, Endgame or ComputerPlayer running in it)
+// resolve to that data manager. A null data manager leaves the
+// current one in place. Scopes nest.
+class DataManagerScope
+{
+public:
+	DataManagerScope(DataManager *dataManager);
+	~DataManagerScope();
+
+private:
+	DataManager *m_previous;
+};
+
+// Puts back the calling thread's random stream, or its lack of one,
+// as it was when the scope began, so that work giving the thread
+// streams of its own (a simulation inside a preendgame's work item,
+// say) leaves whatever it runs inside on its own stream. Scopes nest.
+class RandomStreamScope
+{
+public:
+	RandomStreamScope();
+	~RandomStreamScope();
+
+private:
+	bool m_hadGenerator;
+	RandomGenerator m_generator;
 };
 
 inline DataManager *DataManager::self()
 {
-	return m_self;
+	return m_threadSelf? m_threadSelf : m_self;
 }
 
 inline bool DataManager::exists()
 {
-	return m_self != 0;
+	return self() != 0;
 }
 
 inline Evaluator *DataManager::evaluator()
@@ -186,6 +246,11 @@ inline StrategyParameters *DataManager::strategyParameters()
 	return m_strategyParameters;
 }
 
+inline ResultCache *DataManager::resultCache()
+{
+	return m_resultCache;
+}
+
 inline const PlayerList &DataManager::computerPlayers() const
 {
 	return m_computerPlayers;
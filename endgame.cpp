@@ -20,6 +20,7 @@
 #include <iostream>
 
 #include "computerplayer.h"
+#include "datamanager.h"
 #include "endgame.h"
 #include "game.h"
 #include "move.h"
@@ -30,7 +31,7 @@
 using namespace Quackle;
 
 Endgame::Endgame()
-	: m_logfileIsOpen(false), m_hasHeader(false), m_dispatch(0)
+	: m_logfileIsOpen(false), m_hasHeader(false), m_dispatch(0), m_dataManager(0)
 {
 	m_originalGame.addPosition();
 
@@ -180,11 +181,11 @@ double Endgame::disappoint(EndgameMove &hope, double bestPessimistic)
 	
 	double beforeSpread = m_originalGame.currentPosition().spread(realStartPlayerId);
 	
-	m_endgameGame = m_originalGame;
-	m_endgameGame.setCandidate(hope.move);
-	m_endgameGame.commitCandidate(true);
+	m_endgamePosition = m_originalGame.currentPosition();
+	m_playout.start(&m_endgamePosition, m_originalGame.history());
+	m_playout.commitMove(hope.move);
 	
-	const int startPlayerId = m_endgameGame.currentPosition().currentPlayer().id();
+	const int startPlayerId = m_endgamePosition.currentPlayer().id();
 	const int numberOfPlayers = m_originalGame.currentPosition().players().size();
 
 	int initialPlayNumber;
@@ -198,9 +199,9 @@ double Endgame::disappoint(EndgameMove &hope, double bestPessimistic)
 		
 	//int initialPlayNumber = m_originalGame.currentPosition().nestedness() > 0 ? m_nestedDisappointPlayNumber : m_unnestedDisappointPlayNumber;
 
-	m_endgameGame.currentPosition().kibitz(initialPlayNumber);
+	m_endgamePosition.kibitz(initialPlayNumber);
 	
-	MoveList moves = m_endgameGame.currentPosition().moves();
+	MoveList moves = m_endgamePosition.moves();
 	
 	MoveList::const_iterator moveIt = moves.begin();
 
@@ -212,42 +213,40 @@ double Endgame::disappoint(EndgameMove &hope, double bestPessimistic)
 #ifdef DEBUG_ENDGAME
 		UVcout << "    seeing if " << *moveIt << " wrecks us." << endl;
 #endif
-		m_endgameGame = m_originalGame;
-		m_endgameGame.setCandidate(hope.move);
-		m_endgameGame.commitCandidate(true);
+		// back to just after the hoped-for move
+		m_playout.rewind(1);
 
 		int levelNumber = 1;
 		int playerNumber = 1;
 
-		while (!m_endgameGame.currentPosition().gameOver())
+		while (!m_endgamePosition.gameOver())
 		{
 			for (playerNumber = 1; 
 				 (playerNumber <= numberOfPlayers) && 
-				 !m_endgameGame.currentPosition().gameOver();
+				 !m_endgamePosition.gameOver();
 				 playerNumber++)
 			{
-				const int playerId = m_endgameGame.currentPosition().currentPlayer().id();
+				const int playerId = m_endgamePosition.currentPlayer().id();
 
 				Move move = Move::createNonmove();
 
 				if (playerId == startPlayerId && levelNumber == 1)
 					move = (*moveIt);
 				else
-					move = m_endgameGame.currentPosition().staticBestMove();
+					move = m_endgamePosition.staticBestMove();
 				
 #ifdef DEBUG_ENDGAME
 				UVcout << "      level:" << levelNumber << ", player: " << playerId << ", move: " << move << ", score: " << move.score << ", equity: " << move.equity << endl;
 #endif
-				m_endgameGame.setCandidate(move);
-				m_endgameGame.commitCandidate(true);
+				m_playout.commitMove(move);
 			}
 
 			levelNumber++;
 		}
 
-		m_endgameGame.currentPosition().adjustScoresToFinishGame();
+		m_endgamePosition.adjustScoresToFinishGame();
 
-		double afterSpread = m_endgameGame.currentPosition().spread(realStartPlayerId);
+		double afterSpread = m_endgamePosition.spread(realStartPlayerId);
 		
 		double spread = afterSpread - beforeSpread;
 
@@ -262,6 +261,8 @@ double Endgame::disappoint(EndgameMove &hope, double bestPessimistic)
 
 Move Endgame::solve(int /* nestedness */)
 {
+	DataManagerScope scope(m_dataManager);
+
 #ifdef DEBUG_ENDGAME
 	UVcout << "Endgame::solve() called with position:" << endl;
 #endif
@@ -287,6 +288,9 @@ Move Endgame::solve(int /* nestedness */)
 
 	double bestPessimistic = -1000;
 	EndgameMove bestPessMove(Move::createNonmove());
+
+	m_endgamePosition = m_originalGame.currentPosition();
+	m_playout.start(&m_endgamePosition, m_originalGame.history());
 	
 	EndgameMoveList::iterator moveEnd = m_endgameMoves.end();
 	for (EndgameMoveList::iterator moveIt = m_endgameMoves.begin(); moveIt != moveEnd; ++moveIt)
@@ -300,34 +304,33 @@ Move Endgame::solve(int /* nestedness */)
 		UVcout << "naively playing out " << (*moveIt).move << ":" << endl;
 #endif
 
-		m_endgameGame = m_originalGame;
+		m_playout.rewind();
 		
-		double beforeSpread = m_endgameGame.currentPosition().spread(startPlayerId);
+		double beforeSpread = m_endgamePosition.spread(startPlayerId);
 		
 		int levelNumber = 1;
 		int playerNumber = 1;
 
-		while (!m_endgameGame.currentPosition().gameOver())
+		while (!m_endgamePosition.gameOver())
 		{
 			for (playerNumber = 1; 
 				 (playerNumber <= numberOfPlayers) && 
-				 !m_endgameGame.currentPosition().gameOver();
+				 !m_endgamePosition.gameOver();
 				 playerNumber++)
 			{
-				const int playerId = m_endgameGame.currentPosition().currentPlayer().id();
+				const int playerId = m_endgamePosition.currentPlayer().id();
 
 				Move move = Move::createNonmove();
 
 				if (playerId == startPlayerId && levelNumber == 1)
 					move = (*moveIt).move;
 				else
-					move = m_endgameGame.currentPosition().staticBestMove();
+					move = m_endgamePosition.staticBestMove();
 				
 #ifdef DEBUG_ENDGAME
 				UVcout << "    level:" << levelNumber << ", player: " << playerId << ", move: " << move << ", score: " << move.score << ", equity: " << move.equity << endl;
 #endif
-				m_endgameGame.setCandidate(move);
-				m_endgameGame.commitCandidate(true);
+				m_playout.commitMove(move);
 			}
 
 			levelNumber++;
@@ -338,9 +341,9 @@ Move Endgame::solve(int /* nestedness */)
 		else
 			(*moveIt).outplay = false;
 			
-		m_endgameGame.currentPosition().adjustScoresToFinishGame();
+		m_endgamePosition.adjustScoresToFinishGame();
 
-		double afterSpread = m_endgameGame.currentPosition().spread(startPlayerId);
+		double afterSpread = m_endgamePosition.spread(startPlayerId);
 		
 		double spread = afterSpread - beforeSpread;
 		
@@ -406,21 +409,23 @@ void Endgame::reallyPlayOut(Move &chosenMove, int nestedness)
 	const int startPlayerId = m_originalGame.currentPosition().currentPlayer().id();
 	const int numberOfPlayers = m_originalGame.currentPosition().players().size();
 
-	Game playoutGame = m_originalGame;
+	GamePosition playoutPosition(m_originalGame.currentPosition());
+	Playout playout;
+	playout.start(&playoutPosition, m_originalGame.history());
 		
 	int levelNumber = 1;
 	int playerNumber = 1;
 
-	double beforeSpread = playoutGame.currentPosition().spread(startPlayerId);
+	double beforeSpread = playoutPosition.spread(startPlayerId);
 
-	while (!playoutGame.currentPosition().gameOver())
+	while (!playoutPosition.gameOver())
 	{
 		for (playerNumber = 1; 
 			 (playerNumber <= numberOfPlayers) && 
-			 !playoutGame.currentPosition().gameOver();
+			 !playoutPosition.gameOver();
 			 playerNumber++)
 		{
-			const int playerId = playoutGame.currentPosition().currentPlayer().id();
+			const int playerId = playoutPosition.currentPlayer().id();
 
 			Move move = Move::createNonmove();
 
@@ -431,7 +436,7 @@ void Endgame::reallyPlayOut(Move &chosenMove, int nestedness)
 			else
 			{
 				Endgame quickieEndgame;
-				quickieEndgame.setPosition(playoutGame.currentPosition());
+				quickieEndgame.setPosition(playoutPosition);
 				move = quickieEndgame.solve(nestedness);
 			}
 			
@@ -439,16 +444,15 @@ void Endgame::reallyPlayOut(Move &chosenMove, int nestedness)
 			UVcout << "    level:" << levelNumber << ", player: " << playerId << ", move: " << move << ", score: " << move.score << ", equity: " << move.equity << endl;
 #endif
 			
-			playoutGame.setCandidate(move);
-			playoutGame.commitCandidate(true);
+			playout.commitMove(move);
 		}
 
 		levelNumber++;
 	}
 
-	playoutGame.currentPosition().adjustScoresToFinishGame();
+	playoutPosition.adjustScoresToFinishGame();
 
-	double afterSpread = playoutGame.currentPosition().spread(startPlayerId);
+	double afterSpread = playoutPosition.spread(startPlayerId);
     double spread = afterSpread - beforeSpread;
 
 #ifdef DEBUG_ENDGAME
@@ -470,6 +474,8 @@ bool EndgameMoveList::optimisticComparator(const EndgameMove &move1, const Endga
 
 MoveList Endgame::moves(unsigned int nmoves)
 {
+	DataManagerScope scope(m_dataManager);
+
 	if (m_dispatch)
 	{
 		m_dispatch->signalFractionDone(0);
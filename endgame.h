@@ -29,6 +29,8 @@
 namespace Quackle
 {
 
+class DataManager;
+
 struct EndgameMove
 {
 	EndgameMove(const Move &_move) : move(_move), optimistic(0), pessimistic(0), estimated(0), outplay(false) { }
@@ -63,6 +65,11 @@ public:
 
 	void setDispatch(ComputerDispatch *dispatch);
 
+	// Data manager that solving runs against. If unset, the
+	// one current on the calling thread is used.
+	void setDataManager(DataManager *dataManager);
+	DataManager *dataManager() const;
+
 	// If logfile is an empty string, logging is disabled.
 	// If logfile is the same logfile as currently set, nothing
 	// happens. If it is different, old logfile is closed if it
@@ -108,8 +115,12 @@ protected:
 	UVString m_xmlIndent;
 
 	Game m_originalGame;
-	Game m_endgameGame;
+
+	// playouts are committed on m_endgamePosition and taken back
+	GamePosition m_endgamePosition;
+	Playout m_playout;
 	ComputerDispatch *m_dispatch;
+	DataManager *m_dataManager;
 
 	EndgameMoveList m_endgameMoves;
 	int m_nestedDisappointPlayNumber;
@@ -130,6 +141,16 @@ inline const GamePosition &Endgame::currentPosition() const
 	return m_originalGame.currentPosition();
 }
 
+inline void Endgame::setDataManager(DataManager *dataManager)
+{
+	m_dataManager = dataManager;
+}
+
+inline DataManager *Endgame::dataManager() const
+{
+	return m_dataManager;
+}
+
 inline string Endgame::logfile() const
 {
 	return m_logfile;
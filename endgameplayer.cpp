@@ -18,12 +18,27 @@
 
 #include <iostream>
 
+#include "datamanager.h"
 #include "endgameplayer.h"
 
 //#define DEBUG_COMPUTERPLAYER
 
 using namespace Quackle;
 
+// Bits of a table with room for about as many positions as threads
+// search in seconds, at some 60 thousand a second each, so that a
+// short search doesn't pay for clearing a big one.
+static int tableBits(int seconds, int threads)
+{
+	const double positions = 60000.0 * max(seconds, 1) * threads;
+
+	int ret = 16;
+	while (ret < 22 && (1 << ret) < positions)
+		++ret;
+
+	return ret;
+}
+
 EndgamePlayer::EndgamePlayer()
 {
 	m_name = MARK_UV("Speedy Player");
@@ -41,6 +56,7 @@ Move EndgamePlayer::move()
 
 MoveList EndgamePlayer::moves(int nmoves)
 {
+	DataManagerScope scope(dataManager());
 	if (currentPosition().bag().size() > 0)
 	{
 #ifdef DEBUG_ENDGAME
@@ -53,6 +69,15 @@ MoveList EndgamePlayer::moves(int nmoves)
 		return m_simulator.currentPosition().moves();
 	}
 
+	if (currentPosition().nestedness() == 0 && EndgameSolver::canSolve(currentPosition()))
+	{
+		m_solver.setThreadCount(threadCount());
+		m_solver.setTimeLimit(m_parameters.secondsPerTurn);
+		m_solver.setTableBits(tableBits(m_parameters.secondsPerTurn, threadCount()));
+		m_solver.setPosition(currentPosition());
+		return m_solver.solve(nmoves);
+	}
+
 	m_endgame.setPosition(currentPosition());
 	
     if (nmoves > 1) return m_endgame.moves(nmoves);
@@ -76,5 +101,6 @@ MoveList EndgamePlayer::moves(int nmoves)
 void EndgamePlayer::setDispatch(ComputerDispatch *dispatch)
 {
 	ComputerPlayer::setDispatch(dispatch);
+	m_solver.setDispatch(dispatch);
 	m_endgame.setDispatch(dispatch);
 }
@@ -21,6 +21,7 @@
 
 #include "computerplayer.h"
 #include "endgame.h"
+#include "endgamesolver.h"
 
 namespace Quackle
 {
@@ -40,6 +41,13 @@ public:
 	virtual void setDispatch(ComputerDispatch *dispatch);
 
 private:
+	// Solves endgames of two players we are asked about directly.
+	// Its table is kept from one solve to the next, so keep an
+	// endgame player around rather than making one for each turn.
+	EndgameSolver m_solver;
+
+	// quicker, but only estimates; for endgames within the
+	// calculations of other players, and of more players
 	Endgame m_endgame;
 };
 
@@ -0,0 +1,611 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <thread>
+
+#include "computerplayer.h"
+#include "datamanager.h"
+#include "endgamesolver.h"
+#include "gameparameters.h"
+#include "generator.h"
+
+using namespace Quackle;
+
+// beyond any spread an endgame can swing
+static const int Infinity = 30000;
+
+// locks the table is split between
+static const int TableLockCount = 256;
+
+// Key of one fact about a position (a tile on a square, a tile on a
+// rack, who is to move): splitmix64's finalizer of a code for it.
+// Keys of positions are the exclusive or of the keys of their facts.
+static inline uint64_t factKey(uint64_t code)
+{
+	code += 0x9E3779B97F4A7C15ULL;
+	code = (code ^ (code >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	code = (code ^ (code >> 27)) * 0x94D049BB133111EBULL;
+	return code ^ (code >> 31);
+}
+
+static const uint64_t SecondPlayerKey = factKey(1ULL << 40);
+
+// key of how many scoreless turns came right before
+static inline uint64_t scorelessKey(int turns)
+{
+	return turns == 0? 0 : factKey((1ULL << 40) + turns);
+}
+
+static inline uint64_t squareKey(const Board &board, int row, int col)
+{
+	return factKey((static_cast<uint64_t>(row * QUACKLE_MAXIMUM_BOARD_SIZE + col) << 8) | (board.isBlank(row, col) << 7) | board.letter(row, col));
+}
+
+// key of the tiles of the rack of player side (0 or 1); repeats of
+// a letter are told apart by how many came before them
+static uint64_t rackKey(int side, const Rack &rack)
+{
+	uint64_t ret = 0;
+	const LetterString &tiles = rack.tiles();
+	for (unsigned int i = 0; i < tiles.length(); ++i)
+	{
+		int repeats = 0;
+		for (unsigned int j = 0; j < i; ++j)
+			if (tiles[j] == tiles[i])
+				++repeats;
+
+		ret ^= factKey((1ULL << 32) | (side << 16) | (repeats << 8) | tiles[i]);
+	}
+
+	return ret;
+}
+
+// hash of a play, to find it again among those generated; never zero
+static uint32_t moveHash(const Move &move)
+{
+	uint64_t code = (static_cast<uint64_t>(move.action) << 24) | (move.horizontal << 20) | (move.startrow << 10) | move.startcol;
+	const LetterString &tiles = move.tiles();
+	for (unsigned int i = 0; i < tiles.length(); ++i)
+		code = factKey(code ^ tiles[i]);
+
+	const uint32_t ret = static_cast<uint32_t>(factKey(code));
+	return ret == 0? 1 : ret;
+}
+
+// The search of one thread, on its own copy of the position,
+// which it plays moves on and takes them back from.
+class EndgameSolver::Search
+{
+public:
+	Search(EndgameSolver &solver, bool mainThread);
+
+	// Searches one ply deeper at a time from startDepth, until
+	// the result is exact or the solver is stopped, keeping the
+	// best nmoves plays exact. rotation rotates the first order the
+	// plays are searched in.
+	void deepen(int startDepth, int rotation, int nmoves);
+
+	// the plays and their values from the deepest search finished,
+	// best first, or the plays in order of static equity if none was
+	const MoveList &results() const;
+	int depth() const;
+	bool isExact() const;
+
+private:
+	// value of the position to the player to move, after scoreless
+	// turns in a row
+	int negamax(int depth, int alpha, int beta, int scoreless);
+
+	// value to the player to move of making move, which is one of
+	// theirs
+	int playValue(const Move &move, int depth, int alpha, int beta, int scoreless);
+
+	// static guess at the value of the position
+	int estimate();
+
+	// all plays of the player to move, pass included, best first
+	// by static equity except for firstMove if it is among them
+	void generate(MoveList &moves, uint32_t firstMove);
+
+	void play(const Move &move);
+	void unplay(const Move &move);
+	void switchSides();
+
+	// puts m_racks and the player to move into the position
+	void updatePosition();
+
+	EndgameSolver &m_solver;
+	bool m_mainThread;
+
+	Generator m_generator;
+	int m_ids[2];
+	Rack m_racks[2];
+	int m_side;
+	uint64_t m_key;
+
+	// undo of the board and racks before each play made
+	vector<BoardUndo> m_undos;
+	vector<Rack> m_savedRacks;
+	int m_ply;
+
+	// scoreless turns in a row before the position solved, and
+	// how many end the game
+	int m_rootScoreless;
+	int m_scorelessTurnLimit;
+
+	int m_maximumDepth;
+
+	// whether a position was guessed at rather than searched to
+	// the end of the game, since this was last cleared
+	bool m_horizon;
+
+	long m_nodes;
+
+	MoveList m_results;
+	int m_depth;
+	bool m_exact;
+};
+
+EndgameSolver::Search::Search(EndgameSolver &solver, bool mainThread)
+	: m_solver(solver), m_mainThread(mainThread), m_generator(solver.m_position), m_side(0), m_key(0), m_ply(0), m_horizon(false), m_nodes(0), m_depth(0), m_exact(false)
+{
+	const GamePosition &position = solver.m_position;
+
+	m_ids[0] = position.currentPlayer().id();
+	m_racks[0] = position.currentPlayer().rack();
+	for (const auto &it : position.players())
+	{
+		if (it.id() != m_ids[0])
+		{
+			m_ids[1] = it.id();
+			m_racks[1] = it.rack();
+		}
+	}
+
+	m_key = positionKey(position);
+
+	m_scorelessTurnLimit = QUACKLE_PARAMETERS->numberOfScorelessTurnsThatEndsGame();
+	m_rootScoreless = min(position.scorelessTurnsInARow(), m_scorelessTurnLimit - 1);
+
+	// fewer turns than the limit of scoreless ones either play a
+	// tile or end the game
+	const int tiles = m_racks[0].size() + m_racks[1].size();
+	m_maximumDepth = (tiles + 1) * m_scorelessTurnLimit;
+	m_undos.resize(tiles + 1);
+	m_savedRacks.resize(tiles + 1);
+
+	m_generator.underlyingPosition().setMoves(MoveList());
+}
+
+const MoveList &EndgameSolver::Search::results() const
+{
+	return m_results;
+}
+
+int EndgameSolver::Search::depth() const
+{
+	return m_depth;
+}
+
+bool EndgameSolver::Search::isExact() const
+{
+	return m_exact;
+}
+
+void EndgameSolver::Search::deepen(int startDepth, int rotation, int nmoves)
+{
+	MoveList moves;
+	generate(moves, 0);
+
+	// until a search finishes, the best guess is static equity
+	m_results = moves;
+
+	if (!moves.empty())
+		rotate(moves.begin(), moves.begin() + rotation % moves.size(), moves.end());
+
+	vector<int> values(moves.size());
+	vector<char> exact(moves.size());
+
+	for (int depth = startDepth; depth <= m_maximumDepth; ++depth)
+	{
+		m_horizon = false;
+
+		// the values of the best nmoves plays so far, lowest first
+		vector<int> best;
+
+		for (unsigned int i = 0; i < moves.size(); ++i)
+		{
+			const int alpha = static_cast<int>(best.size()) < nmoves? -Infinity : best.front();
+
+			values[i] = playValue(moves[i], depth, alpha, Infinity, m_rootScoreless);
+			exact[i] = values[i] > alpha;
+
+			if (m_solver.m_stop)
+				break;
+
+			if (exact[i])
+			{
+				best.insert(upper_bound(best.begin(), best.end(), values[i]), values[i]);
+				if (static_cast<int>(best.size()) > nmoves)
+					best.erase(best.begin());
+			}
+		}
+
+		if (m_solver.m_stop)
+			break;
+
+		// order by value, exact values ahead of bounds on them
+		vector<int> order(moves.size());
+		for (unsigned int i = 0; i < order.size(); ++i)
+			order[i] = i;
+		stable_sort(order.begin(), order.end(), [&](int a, int b)
+		{
+			return values[a] != values[b]? values[a] > values[b] : exact[a] > exact[b];
+		});
+
+		MoveList sortedMoves;
+		for (unsigned int i = 0; i < order.size(); ++i)
+		{
+			sortedMoves.push_back(moves[order[i]]);
+			sortedMoves.back().equity = values[order[i]];
+		}
+
+		moves = sortedMoves;
+		m_results = sortedMoves;
+		m_depth = depth;
+
+		if (m_mainThread)
+		{
+			m_solver.m_limitsApply = true;
+			if (m_solver.m_dispatch)
+				m_solver.m_dispatch->signalFractionDone(static_cast<double>(depth) / m_maximumDepth);
+		}
+
+		if (!m_horizon)
+		{
+			m_exact = true;
+			break;
+		}
+	}
+
+	// nodes not yet counted by checkLimits
+	m_solver.m_nodes += m_nodes % 1024;
+}
+
+int EndgameSolver::Search::negamax(int depth, int alpha, int beta, int scoreless)
+{
+	if ((++m_nodes & 1023) == 0)
+		m_solver.checkLimits(1024, m_mainThread);
+
+	if (m_solver.m_stop)
+		return 0;
+
+	const uint64_t key = m_key ^ scorelessKey(scoreless);
+
+	TableEntry entry;
+	uint32_t tableMove = 0;
+	if (m_solver.probe(key, &entry))
+	{
+		tableMove = entry.move;
+
+		if (entry.depth >= depth && (entry.bound == Exact || (entry.bound == LowerBound && entry.value >= beta) || (entry.bound == UpperBound && entry.value <= alpha)))
+		{
+			if (entry.depth != Solved)
+				m_horizon = true;
+			return entry.value;
+		}
+	}
+
+	if (depth == 0)
+	{
+		m_horizon = true;
+		return estimate();
+	}
+
+	MoveList moves;
+	generate(moves, tableMove);
+
+	const bool outerHorizon = m_horizon;
+	m_horizon = false;
+
+	const int originalAlpha = alpha;
+	int best = -Infinity;
+	uint32_t bestMove = 0;
+
+	const MoveList::const_iterator end(moves.end());
+	for (MoveList::const_iterator it = moves.begin(); it != end; ++it)
+	{
+		const int value = playValue(*it, depth, alpha, beta, scoreless);
+		if (m_solver.m_stop)
+			return 0;
+
+		if (value > best)
+		{
+			best = value;
+			bestMove = moveHash(*it);
+		}
+
+		if (best > alpha)
+			alpha = best;
+		if (alpha >= beta)
+			break;
+	}
+
+	const Bound bound = best <= originalAlpha? UpperBound : best >= beta? LowerBound : Exact;
+	m_solver.store(key, best, m_horizon? depth : Solved, bound, bestMove);
+
+	m_horizon = m_horizon || outerHorizon;
+	return best;
+}
+
+int EndgameSolver::Search::playValue(const Move &move, int depth, int alpha, int beta, int scoreless)
+{
+	const bool pass = move.action == Move::Pass;
+	const int score = pass? 0 : move.score;
+
+	if (!pass && (m_racks[m_side] - move).empty())
+		return score + 2 * m_racks[1 - m_side].score();
+
+	// as in GamePosition::advanceTurn, passes and plays scoring
+	// nothing are scoreless turns, and enough of them in a row end
+	// the game with each player losing what they hold
+	const int nextScoreless = score == 0? scoreless + 1 : 0;
+	if (nextScoreless >= m_scorelessTurnLimit)
+		return score + m_racks[1 - m_side].score() - (pass? m_racks[m_side] : m_racks[m_side] - move).score();
+
+	if (pass)
+	{
+		switchSides();
+		const int value = -negamax(depth - 1, -beta, -alpha, nextScoreless);
+		switchSides();
+		return value;
+	}
+
+	play(move);
+	const int value = score - negamax(depth - 1, score - beta, score - alpha, nextScoreless);
+	unplay(move);
+	return value;
+}
+
+int EndgameSolver::Search::estimate()
+{
+	m_generator.kibitz(1, Generator::CannotExchange);
+	return static_cast<int>(floor(m_generator.kibitzList().front().equity + 0.5));
+}
+
+void EndgameSolver::Search::generate(MoveList &moves, uint32_t firstMove)
+{
+	m_generator.kibitz(numeric_limits<int>::max(), Generator::CannotExchange);
+	moves = m_generator.kibitzList();
+
+	bool hasPass = false;
+	for (MoveList::const_iterator it = moves.begin(); it != moves.end() && !hasPass; ++it)
+		hasPass = (*it).action == Move::Pass;
+	if (!hasPass)
+		moves.push_back(Move::createPassMove());
+
+	if (firstMove != 0)
+	{
+		for (MoveList::iterator it = moves.begin(); it != moves.end(); ++it)
+		{
+			if (moveHash(*it) == firstMove)
+			{
+				rotate(moves.begin(), it, it + 1);
+				break;
+			}
+		}
+	}
+}
+
+void EndgameSolver::Search::play(const Move &move)
+{
+	Board &board = m_generator.underlyingPosition().underlyingBoardReference();
+	BoardUndo &undo = m_undos[m_ply];
+
+	Generator::makeMove(board, move, /* regenerate crosses */ true, &undo);
+	for (int i = 0; i < undo.placedCount; ++i)
+		m_key ^= squareKey(board, undo.placedRows[i], undo.placedColumns[i]);
+
+	m_savedRacks[m_ply] = m_racks[m_side];
+	m_key ^= rackKey(m_side, m_racks[m_side]);
+	m_racks[m_side] = m_racks[m_side] - move;
+	m_key ^= rackKey(m_side, m_racks[m_side]);
+
+	++m_ply;
+	switchSides();
+}
+
+void EndgameSolver::Search::unplay(const Move & /* move */)
+{
+	switchSides();
+	--m_ply;
+
+	m_key ^= rackKey(m_side, m_racks[m_side]);
+	m_racks[m_side] = m_savedRacks[m_ply];
+	m_key ^= rackKey(m_side, m_racks[m_side]);
+
+	Board &board = m_generator.underlyingPosition().underlyingBoardReference();
+	const BoardUndo &undo = m_undos[m_ply];
+	for (int i = 0; i < undo.placedCount; ++i)
+		m_key ^= squareKey(board, undo.placedRows[i], undo.placedColumns[i]);
+	board.unmakeMove(undo);
+
+	updatePosition();
+}
+
+void EndgameSolver::Search::switchSides()
+{
+	m_side = 1 - m_side;
+	m_key ^= SecondPlayerKey;
+	updatePosition();
+}
+
+void EndgameSolver::Search::updatePosition()
+{
+	GamePosition &position = m_generator.underlyingPosition();
+	position.setPlayerRack(m_ids[0], m_racks[0], /* adjust bag */ false);
+	position.setPlayerRack(m_ids[1], m_racks[1], /* adjust bag */ false);
+	position.setCurrentPlayer(m_ids[m_side]);
+}
+
+////////////
+
+EndgameSolver::EndgameSolver()
+	: m_dispatch(0), m_dataManager(0), m_threadCount(1), m_timeLimit(0), m_nodeLimit(0), m_tableBits(18), m_tableLocks(TableLockCount), m_nodes(0), m_stop(false), m_limitsApply(false), m_exact(false), m_depth(0)
+{
+}
+
+EndgameSolver::~EndgameSolver()
+{
+}
+
+bool EndgameSolver::canSolve(const GamePosition &position)
+{
+	// without a limit on scoreless turns, the game need not end
+	return position.bag().empty() && position.players().size() == 2 && !position.gameOver() && QUACKLE_PARAMETERS->numberOfScorelessTurnsThatEndsGame() > 0;
+}
+
+uint64_t EndgameSolver::positionKey(const GamePosition &position)
+{
+	uint64_t ret = 0;
+
+	const Board &board = position.board();
+	for (int row = 0; row < board.height(); ++row)
+		for (int col = 0; col < board.width(); ++col)
+			if (board.isOccupied(row, col))
+				ret ^= squareKey(board, row, col);
+
+	ret ^= rackKey(0, position.currentPlayer().rack());
+	if (position.players().size() > 1)
+		ret ^= rackKey(1, position.nextPlayer()->rack());
+
+	return ret;
+}
+
+void EndgameSolver::setPosition(const GamePosition &position)
+{
+	m_position = position;
+}
+
+void EndgameSolver::setTableBits(int bits)
+{
+	m_tableBits = bits;
+}
+
+bool EndgameSolver::probe(uint64_t key, TableEntry *entry)
+{
+	const size_t index = key & (m_table.size() - 1);
+	lock_guard<mutex> lock(m_tableLocks[index % TableLockCount]);
+
+	if (m_table[index].key != key)
+		return false;
+
+	*entry = m_table[index];
+	return true;
+}
+
+void EndgameSolver::store(uint64_t key, int value, int depth, Bound bound, uint32_t move)
+{
+	const size_t index = key & (m_table.size() - 1);
+	lock_guard<mutex> lock(m_tableLocks[index % TableLockCount]);
+
+	// keep the deeper search of a position
+	TableEntry &entry = m_table[index];
+	if (entry.key == key && entry.depth > depth)
+		return;
+
+	entry.key = key;
+	entry.value = value;
+	entry.depth = depth;
+	entry.bound = bound;
+	entry.move = move;
+}
+
+bool EndgameSolver::checkLimits(long nodes, bool mainThread)
+{
+	m_nodes += nodes;
+
+	if (m_limitsApply && ((m_nodeLimit > 0 && m_nodes >= m_nodeLimit) || (m_timeLimit > 0 && m_stopwatch.exceeded(m_timeLimit))))
+		m_stop = true;
+
+	// only the calling thread talks to the dispatch
+	if (mainThread && m_dispatch && m_dispatch->shouldAbort())
+		m_stop = true;
+
+	return m_stop;
+}
+
+MoveList EndgameSolver::solve(int nmoves)
+{
+	DataManagerScope scope(m_dataManager);
+
+	m_stopwatch.start();
+	m_nodes = 0;
+	m_stop = false;
+	m_limitsApply = false;
+
+	if (m_table.size() != (1ULL << m_tableBits))
+		m_table.assign(1ULL << m_tableBits, TableEntry());
+
+	DataManager *dataManager = DataManager::self();
+
+	vector<thread> helpers;
+	for (int i = 1; i < m_threadCount; ++i)
+	{
+		helpers.push_back(thread([this, dataManager, i, nmoves]()
+		{
+			DataManagerScope scope(dataManager);
+			Search helper(*this, /* main thread */ false);
+			helper.deepen(1 + i % 2, i, nmoves);
+		}));
+	}
+
+	Search search(*this, /* main thread */ true);
+	search.deepen(1, 0, nmoves);
+
+	m_stop = true;
+	for (auto &it : helpers)
+		it.join();
+
+	m_exact = search.isExact();
+	m_depth = search.depth();
+
+	const int spread = m_position.spread(m_position.currentPlayer().id());
+
+	MoveList ret;
+	const MoveList::const_iterator end(search.results().end());
+	for (MoveList::const_iterator it = search.results().begin(); it != end && static_cast<int>(ret.size()) < nmoves; ++it)
+	{
+		Move move(*it);
+		m_position.ensureMovePrettiness(move);
+
+		if (m_depth > 0)
+		{
+			const double finalSpread = spread + move.equity;
+			move.win = finalSpread > 0? 1 : finalSpread < 0? 0 : 0.5;
+		}
+
+		ret.push_back(move);
+	}
+
+	return ret;
+}
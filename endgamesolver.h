@@ -0,0 +1,210 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUACKLE_ENDGAMESOLVER_H
+#define QUACKLE_ENDGAMESOLVER_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "clock.h"
+#include "game.h"
+
+using namespace std;
+
+namespace Quackle
+{
+
+class ComputerDispatch;
+class DataManager;
+
+// Solves endgames, where the bag is empty and two players remain,
+// by iterative deepening negamax with alpha-beta pruning over every
+// play. Plays are searched in order of static equity, after the
+// best play found for the position before. Results are kept in a
+// transposition table keyed on the board, both racks, the player
+// to move and the scoreless turns before. Extra threads search the same tree in a different order,
+// sharing the table (lazy SMP), so that the main thread finds more
+// of it already solved.
+// Deepening stops once a search reaches the end of every line it
+// looks at, when the result is exact, or when the time or node
+// limit is reached, when it is that of the deepest search finished.
+// The game ends after as many scoreless turns in a row as the game
+// parameters say, with each player losing what they hold.
+class EndgameSolver
+{
+public:
+	EndgameSolver();
+	~EndgameSolver();
+
+	// whether position is one we solve
+	static bool canSolve(const GamePosition &position);
+
+	// Key of the tiles on the board and the racks of the player to
+	// move and the next player, as positions are keyed in the table.
+	static uint64_t positionKey(const GamePosition &position);
+
+	void setPosition(const GamePosition &position);
+	const GamePosition &position() const;
+
+	// used from the calling thread only, to abort and to report
+	// progress
+	void setDispatch(ComputerDispatch *dispatch);
+
+	// Data manager that solving runs against. If unset, the
+	// one current on the calling thread is used.
+	void setDataManager(DataManager *dataManager);
+	DataManager *dataManager() const;
+
+	// threads to search with; defaults to 1
+	void setThreadCount(int threadCount);
+	int threadCount() const;
+
+	// Seconds (zero, the default, for no limit) and nodes (zero for
+	// no limit) after which to stop deepening. The first search, one
+	// play deep, always finishes.
+	void setTimeLimit(int seconds);
+	void setNodeLimit(long nodes);
+
+	// Size of the transposition table, as 2 ** bits entries of 16
+	// bytes. The table is kept between solves of one solver.
+	void setTableBits(int bits);
+
+	// The best nmoves plays, best first. The equity of each is the
+	// spread it gains to the end of the game against the best
+	// replies found, and its win 1, 0 or 0.5 as the final spread is
+	// positive, negative or zero.
+	MoveList solve(int nmoves = 1);
+
+	// whether the result of the last solve is exact
+	bool isExact() const;
+
+	// plies searched by the last solve, and nodes visited
+	int depth() const;
+	long nodes() const;
+
+private:
+	class Search;
+	friend class Search;
+
+	// a position's value as far as it has been searched
+	struct TableEntry
+	{
+		uint64_t key;
+		short value;
+
+		// plies searched below the position, or Solved
+		unsigned char depth;
+
+		// Exact, LowerBound or UpperBound
+		unsigned char bound;
+
+		// hash of the best play found, or zero
+		uint32_t move;
+	};
+
+	enum Bound { Exact = 0, LowerBound = 1, UpperBound = 2 };
+	enum { Solved = 255 };
+
+	bool probe(uint64_t key, TableEntry *entry);
+	void store(uint64_t key, int value, int depth, Bound bound, uint32_t move);
+
+	// called from searches now and then; returns whether to stop
+	bool checkLimits(long nodes, bool mainThread);
+
+	GamePosition m_position;
+	ComputerDispatch *m_dispatch;
+	DataManager *m_dataManager;
+
+	int m_threadCount;
+	int m_timeLimit;
+	long m_nodeLimit;
+	int m_tableBits;
+
+	vector<TableEntry> m_table;
+	vector<mutex> m_tableLocks;
+
+	Stopwatch m_stopwatch;
+	atomic<long> m_nodes;
+	atomic<bool> m_stop;
+	atomic<bool> m_limitsApply;
+
+	bool m_exact;
+	int m_depth;
+};
+
+inline const GamePosition &EndgameSolver::position() const
+{
+	return m_position;
+}
+
+inline void EndgameSolver::setDispatch(ComputerDispatch *dispatch)
+{
+	m_dispatch = dispatch;
+}
+
+inline void EndgameSolver::setDataManager(DataManager *dataManager)
+{
+	m_dataManager = dataManager;
+}
+
+inline DataManager *EndgameSolver::dataManager() const
+{
+	return m_dataManager;
+}
+
+inline void EndgameSolver::setThreadCount(int threadCount)
+{
+	m_threadCount = threadCount < 1? 1 : threadCount;
+}
+
+inline int EndgameSolver::threadCount() const
+{
+	return m_threadCount;
+}
+
+inline void EndgameSolver::setTimeLimit(int seconds)
+{
+	m_timeLimit = seconds;
+}
+
+inline void EndgameSolver::setNodeLimit(long nodes)
+{
+	m_nodeLimit = nodes;
+}
+
+inline bool EndgameSolver::isExact() const
+{
+	return m_exact;
+}
+
+inline int EndgameSolver::depth() const
+{
+	return m_depth;
+}
+
+inline long EndgameSolver::nodes() const
+{
+	return m_nodes;
+}
+
+}
+
+#endif
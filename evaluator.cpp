@@ -16,6 +16,8 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdint>
+
 #include "board.h"
 #include "datamanager.h"
 #include "game.h"
@@ -70,12 +72,64 @@ double ScorePlusLeaveEvaluator::sharedConsideration(const GamePosition &position
 	return 0;
 }
 
+// The moves of a position share a handful of leaves, and the value of
+// a leave depends only on strategy and alphabet, so each thread keeps
+// the values of leaves it has seen lately.
+struct LeaveValueMemoEntry
+{
+	uint64_t key;
+	double value;
+};
+
+static const int leaveValueMemoBits = 10;
+static thread_local LeaveValueMemoEntry leaveValueMemo[1 << leaveValueMemoBits];
+static thread_local const StrategyParameters *leaveValueMemoStrategy = 0;
+static thread_local unsigned int leaveValueMemoGeneration = 0;
+static thread_local unsigned int leaveValueMemoAlphabetGeneration = 0;
+
 double ScorePlusLeaveEvaluator::leaveValue(const LetterString &leave) const
 {
 	LetterString alphabetized = String::alphabetize(leave);
-	
-	if (QUACKLE_STRATEGY_PARAMETERS->hasSuperleaves() && QUACKLE_STRATEGY_PARAMETERS->superleave(alphabetized))
-		return QUACKLE_STRATEGY_PARAMETERS->superleave(alphabetized);
+
+	// leaves of up to seven letters pack into a key that is never zero
+	const int length = alphabetized.length();
+	if (length > 7)
+		return calculateLeaveValue(alphabetized);
+
+	uint64_t key = length + 1;
+	for (int i = 0; i < length; ++i)
+		key = (key << 8) | (unsigned char)alphabetized[i];
+
+	const StrategyParameters *strategy = QUACKLE_STRATEGY_PARAMETERS;
+	const unsigned int alphabetGeneration = QUACKLE_ALPHABET_PARAMETERS->generation();
+	if (strategy != leaveValueMemoStrategy || strategy->generation() != leaveValueMemoGeneration || alphabetGeneration != leaveValueMemoAlphabetGeneration)
+	{
+		for (auto &it : leaveValueMemo)
+			it.key = 0;
+
+		leaveValueMemoStrategy = strategy;
+		leaveValueMemoGeneration = strategy->generation();
+		leaveValueMemoAlphabetGeneration = alphabetGeneration;
+	}
+
+	LeaveValueMemoEntry &entry = leaveValueMemo[(key * 0x9e3779b97f4a7c15ULL) >> (64 - leaveValueMemoBits)];
+	if (entry.key != key)
+	{
+		entry.key = key;
+		entry.value = calculateLeaveValue(alphabetized);
+	}
+
+	return entry.value;
+}
+
+double ScorePlusLeaveEvaluator::calculateLeaveValue(const LetterString &leave) const
+{
+	if (QUACKLE_STRATEGY_PARAMETERS->hasSuperleaves())
+	{
+		const double superleave = QUACKLE_STRATEGY_PARAMETERS->superleave(leave);
+		if (superleave)
+			return superleave;
+	}
 
 	double value = 0;
 
@@ -89,14 +143,14 @@ double ScorePlusLeaveEvaluator::leaveValue(const LetterString &leave) const
 				value += QUACKLE_STRATEGY_PARAMETERS->tileWorth(leaveIt);
 
 		if (QUACKLE_STRATEGY_PARAMETERS->hasSyn2())
-			for (unsigned int i = 0; i < alphabetized.length() - 1; ++i)
-				if (alphabetized[i] == alphabetized[i + 1])
-					value += QUACKLE_STRATEGY_PARAMETERS->syn2(alphabetized[i], alphabetized[i]);
-
-		uniqleave += alphabetized[0];
-		for (unsigned int i = 1; i < alphabetized.length(); ++i)
-			if (uniqleave[uniqleave.length() - 1] != alphabetized[i])
-				uniqleave += alphabetized[i];
+			for (unsigned int i = 0; i < leave.length() - 1; ++i)
+				if (leave[i] == leave[i + 1])
+					value += QUACKLE_STRATEGY_PARAMETERS->syn2(leave[i], leave[i]);
+
+		uniqleave += leave[0];
+		for (unsigned int i = 1; i < leave.length(); ++i)
+			if (uniqleave[uniqleave.length() - 1] != leave[i])
+				uniqleave += leave[i];
 
 		if (uniqleave.length() >= 2 && QUACKLE_STRATEGY_PARAMETERS->hasSyn2())
 		{
@@ -57,6 +57,11 @@ public:
 	virtual double sharedConsideration(const GamePosition &position, const Move &move) const;
 
 	virtual double leaveValue(const LetterString &leave) const;
+
+protected:
+	// leaveValue of an alphabetized leave, without looking in the
+	// memo of recent leaves
+	double calculateLeaveValue(const LetterString &leave) const;
 };
 
 }
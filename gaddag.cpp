@@ -0,0 +1,83 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gaddag.h"
+
+using namespace Quackle;
+
+void GaddagNode::set(uint32_t firstChildOffset, unsigned char info)
+{
+	const uint64_t word = (uint64_t)info << infoShift;
+	memcpy(data, &firstChildOffset, sizeof(firstChildOffset));
+	memcpy(data + 4, &word, sizeof(word));
+}
+
+// Sets mask to the letterBits of node's children. Returns false if
+// a child is at or past end, or children are out of letter order.
+static bool maskChildren(const GaddagNode &node, const GaddagNode *end, uint64_t *mask)
+{
+	*mask = 0;
+	uint64_t previousBit = 0;
+	for (const GaddagNode *child = node.firstChild(); child; child = child->nextSibling())
+	{
+		if (child >= end)
+			return false;
+
+		const Letter letter = child->letter();
+		if (letter != QUACKLE_GADDAG_SEPARATOR && (letter < QUACKLE_FIRST_LETTER || letter >= QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE))
+			return false;
+
+		const uint64_t bit = GaddagNode::letterBit(letter);
+		if (bit <= previousBit)
+			return false;
+
+		*mask |= bit;
+		previousBit = bit;
+	}
+
+	return true;
+}
+
+bool GaddagNode::linkChildren(GaddagNode *nodes, size_t nodeCount)
+{
+	const GaddagNode *end = nodes + nodeCount;
+	for (size_t i = 0; i < nodeCount; ++i)
+	{
+		uint64_t mask;
+		if (!maskChildren(nodes[i], end, &mask))
+			return false;
+
+		const uint64_t word = nodes[i].word() | mask;
+		memcpy(nodes[i].data + 4, &word, sizeof(word));
+	}
+
+	return true;
+}
+
+bool GaddagNode::checkChildren(const GaddagNode *nodes, size_t nodeCount)
+{
+	const GaddagNode *end = nodes + nodeCount;
+	for (size_t i = 0; i < nodeCount; ++i)
+	{
+		uint64_t mask;
+		if (!maskChildren(nodes[i], end, &mask) || mask != nodes[i].childMask())
+			return false;
+	}
+
+	return true;
+}
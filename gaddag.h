@@ -19,6 +19,9 @@
 #ifndef QUACKLE_GADDAG_H
 #define QUACKLE_GADDAG_H
 
+#include <cstdint>
+#include <cstring>
+
 #include "alphabetparameters.h"
 
 #define QUACKLE_GADDAG_SEPARATOR QUACKLE_NULL_MARK
@@ -26,6 +29,12 @@
 namespace Quackle
 {
 
+// In-memory gaddag node, as v3 gaddag files store it, or expanded
+// from one of the older node formats (see LexiconInterpreter). It
+// holds the offset to its first child, the node's byte as in v1
+// files (letter, terminal and last-child flags) and a mask of the
+// letters of its children, so that a child is found with a mask test
+// and a popcount instead of a walk along the sibling list.
 class GaddagNode
 {
 public:
@@ -34,26 +43,79 @@ public:
 	const GaddagNode *firstChild() const;
 	const GaddagNode *nextSibling() const;
 	const GaddagNode *child(Letter l) const;
+
+	// letterBit of each child's letter
+	uint64_t childMask() const;
+
+	// the child whose letterBit is bit; bit must be set in childMask()
+	const GaddagNode *childForBit(uint64_t bit) const;
+
+	// Letter l takes bit l - QUACKLE_FIRST_LETTER, as in a
+	// LetterBitset; the separator, which sorts after every letter,
+	// takes the bit after the last letter's.
+	static uint64_t letterBit(Letter l);
+
+	// firstChildOffset is in nodes (zero if there are no children);
+	// info is the node's byte as in v1 files.
+	void set(uint32_t firstChildOffset, unsigned char info);
+
+	// Fills in the child masks of nodeCount nodes that have been
+	// set. Returns false if some node's children are out of range
+	// or not in letter order.
+	static bool linkChildren(GaddagNode *nodes, size_t nodeCount);
+
+	// Returns true if each of nodeCount nodes read whole, as from a
+	// v3 file, has its children in range and in letter order, and
+	// the child mask linkChildren would give it.
+	static bool checkChildren(const GaddagNode *nodes, size_t nodeCount);
+
 private:
-	unsigned char data[4];
+	static const int infoShift = 56;
+	static const uint64_t maskBits = (1ULL << infoShift) - 1;
+
+	uint64_t word() const;
+
+	// child offset, then child mask with the info byte on top
+	unsigned char data[12];
 };
 
+inline int gaddagPopcount(uint64_t mask)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(mask);
+#else
+	mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+	mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+	mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((mask * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+inline uint64_t
+GaddagNode::word() const
+{
+	uint64_t word;
+	memcpy(&word, data + 4, sizeof(word));
+	return word;
+}
+
 inline Letter
 GaddagNode::letter() const
 {
-	return (data[3] & 0x3F /*0b00111111*/);
+	return (word() >> infoShift) & 0x3F /*0b00111111*/;
 }
 
 inline bool
 GaddagNode::isTerminal() const
 {
-	return (data[3] & 0x40) != 0 /*0b01000000*/;
+	return (word() >> infoShift) & 0x40 /*0b01000000*/;
 }
 
 inline const GaddagNode *
 GaddagNode::firstChild() const
 {
-	unsigned int p = (data[0] << 16) + (data[1] << 8) + (data[2]);
+	uint32_t p;
+	memcpy(&p, data, sizeof(p));
 	if (p == 0) {
 		return 0;
 	} else {
@@ -61,45 +123,41 @@ GaddagNode::firstChild() const
 	}
 }
 
-/*
 inline const GaddagNode *
-GaddagNode::firstChild() const
+GaddagNode::nextSibling() const
 {
-	int p = (data[0] << 16) + (data[1] << 8) + (data[2]);
-	if (p == 0) 
-	{
+	if ((word() >> infoShift) & 0x80 /*0b10000000*/) {
 		return 0;
-	} 
-	else 
-	{
-		if(p & 0x00800000)
-			p |= 0xff000000;
-		return this + p;
+	} else {
+		return this + 1; // assumes packed array of siblings
 	}
 }
-*/
+
+inline uint64_t
+GaddagNode::childMask() const
+{
+	return word() & maskBits;
+}
+
+inline uint64_t
+GaddagNode::letterBit(Letter l)
+{
+	return l == QUACKLE_GADDAG_SEPARATOR? (1ULL << QUACKLE_MAXIMUM_ALPHABET_SIZE) : (1ULL << (l - QUACKLE_FIRST_LETTER));
+}
 
 inline const GaddagNode *
-GaddagNode::nextSibling() const
+GaddagNode::childForBit(uint64_t bit) const
 {
-	if (data[3] & 0x80 /*0b10000000*/) {
-		return 0;
-	} else {
-		return this + 1; // assumes packed array of siblings
-	}
+	return firstChild() + gaddagPopcount(childMask() & (bit - 1));
 }
  
 inline const GaddagNode *
 GaddagNode::child(Letter l) const
 {
-	for (const GaddagNode *child = firstChild(); child; child = child->nextSibling()) {
-		if (child->letter() == l) {
-			return child;
-		} else if (l != QUACKLE_GADDAG_SEPARATOR && child->letter() > l) {
-			return 0;
-		}
-	}
-	return 0;
+	const uint64_t bit = letterBit(l);
+	if (!(childMask() & bit))
+		return 0;
+	return childForBit(bit);
 }
 
 }
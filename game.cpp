@@ -248,9 +248,10 @@ GamePosition::GamePosition()
 	resetBag();
 }
 
-void GamePosition::kibitz(int nmoves)
+void GamePosition::kibitz(int nmoves, double equityWindow)
 {
 	Generator generator(*this);
+	generator.setEquityWindow(equityWindow);
 	generator.kibitz(nmoves, exchangeAllowed()? Generator::RegularKibitz : Generator::CannotExchange);
 
 	m_moves = generator.kibitzList();
@@ -441,14 +442,12 @@ int GamePosition::handleOverdraw(const LetterString &letters, LetterString *thro
 	return ValidOverdraw;
 }
 
-void GamePosition::makeMove(const Move &move, bool maintainBoard)
+void GamePosition::makeMove(const Move &move, bool maintainBoard, BoardUndo *undo)
 {
 	if (!move.isChallengedPhoney())
-	{
-		Generator generator(*this);
-		generator.makeMove(move, maintainBoard);
-		m_board = generator.position().board();
-	}
+		Generator::makeMove(m_board, move, maintainBoard, undo);
+	else if (undo)
+		m_board.makeMove(Move::createNonmove(), undo);
 
 	if (move.action == Move::Exchange)
 		m_bag.toss(move.usedTiles());
@@ -462,9 +461,7 @@ void GamePosition::scoreMove(Move &move)
 
 void GamePosition::ensureBoardIsPreparedForAnalysis()
 {
-	Generator generator(*this);
-	generator.allCrosses();
-	m_board = generator.position().board();
+	Generator::allCrosses(m_board);
 }
 
 int GamePosition::calculateScore(const Move &move)
@@ -770,6 +767,24 @@ void GamePosition::resetBag()
 }
 
 bool GamePosition::incrementTurn(const History* history)
+{
+	if (!history)
+		return advanceTurn(false, 0);
+
+	const GamePosition *faced = 0;
+	if (!m_players.empty() && m_currentPlayer != m_players.end())
+	{
+		PlayerList::const_iterator nextCurrentPlayer(m_currentPlayer);
+		nextCurrentPlayer++;
+		if (nextCurrentPlayer == m_players.end())
+			nextCurrentPlayer = m_players.begin();
+		faced = history->lastPositionFacedBy((*nextCurrentPlayer).id());
+	}
+
+	return advanceTurn(true, faced? &faced->m_tilesOnRack : 0);
+}
+
+bool GamePosition::advanceTurn(bool countTiles, const int *tilesOnRackFaced)
 {
 	if (gameOver() || m_players.empty())
 		return false;
@@ -789,15 +804,14 @@ bool GamePosition::incrementTurn(const History* history)
 
 		// now moveTiles is the tiles that are in play but not on rack
 		removeLetters(moveTiles.tiles());
-		if (history)
+		if (countTiles)
 		{
 			PlayerList::iterator nextCurrentPlayer(m_currentPlayer);
 			nextCurrentPlayer++;
 			if (nextCurrentPlayer == m_players.end())
 				nextCurrentPlayer = m_players.begin();
-			const Quackle::PositionList positions(history->positionsFacedBy((*nextCurrentPlayer).id()));
-			if (positions.size() > 0)
-				m_tilesOnRack = positions.back().m_tilesOnRack;
+			if (tilesOnRackFaced)
+				m_tilesOnRack = *tilesOnRackFaced;
 			else if (m_turnNumber > 1)
 			{
 				// this can happen inside of a simming player engine
@@ -1178,6 +1192,15 @@ PositionList History::positionsFacedBy(int playerID) const
 	return ret;
 }
 
+const GamePosition *History::lastPositionFacedBy(int playerID) const
+{
+	for (PositionList::const_reverse_iterator it = rbegin(); it != rend(); ++it)
+		if ((*it).playerOnTurn().id() == playerID)
+			return &(*it);
+
+	return 0;
+}
+
 const GamePosition &History::positionAt(const HistoryLocation &location, bool *exists) const
 {
 	for (PositionList::const_reverse_iterator it = rbegin(); it != rend(); ++it)
@@ -1306,6 +1329,173 @@ void History::eraseAfter(const HistoryLocation &location)
 
 ////////
 
+Playout::Playout()
+	: m_position(0), m_depth(0)
+{
+}
+
+void Playout::start(GamePosition *position, const History &history)
+{
+	m_position = position;
+	m_depth = 0;
+
+	const PlayerList &players = position->m_players;
+	m_tilesOnRackFaced.assign(players.size(), 0);
+	m_hasFaced.assign(players.size(), false);
+
+	for (unsigned int i = 0; i < players.size(); ++i)
+	{
+		const GamePosition *faced = history.lastPositionFacedBy(players[i].id());
+		if (faced)
+		{
+			m_tilesOnRackFaced[i] = faced->m_tilesOnRack;
+			m_hasFaced[i] = true;
+		}
+	}
+
+	// Game would add position itself to its history before committing
+	if (position->m_playerOnTurn != position->m_players.end())
+	{
+		const int onTurn = position->m_playerOnTurn - position->m_players.begin();
+		m_tilesOnRackFaced[onTurn] = position->m_tilesOnRack;
+		m_hasFaced[onTurn] = true;
+	}
+}
+
+void Playout::commitCandidate(bool maintainBoard)
+{
+	if (m_position->gameOver())
+		return;
+
+	commit(savePly(), maintainBoard);
+}
+
+void Playout::commitMove(const Move &move, bool maintainBoard)
+{
+	if (m_position->gameOver())
+		return;
+
+	// the move made is saved as it was before move was set
+	Ply &ply = savePly();
+	m_position->setMoveMade(move);
+	commit(ply, maintainBoard);
+}
+
+Playout::Ply &Playout::savePly()
+{
+	GamePosition &position = *m_position;
+
+	if (m_depth == (int)m_plies.size())
+		m_plies.push_back(Ply());
+
+	Ply &ply = m_plies[m_depth++];
+
+	// assigning into the ply's own storage reuses it
+	ply.players.resize(position.m_players.size());
+	for (unsigned int i = 0; i < position.m_players.size(); ++i)
+	{
+		const Player &player = position.m_players[i];
+		ply.players[i].rack = player.rack();
+		ply.players[i].score = player.score();
+		ply.players[i].drawnLetters = player.drawnLetters();
+	}
+
+	ply.currentPlayer = position.m_currentPlayer - position.m_players.begin();
+	ply.playerOnTurn = position.m_playerOnTurn - position.m_players.begin();
+	ply.moves.swap(position.m_moves);
+	position.m_moves.clear();
+	ply.moveMade = position.m_moveMade;
+	ply.committedMove = position.m_committedMove;
+	ply.turnNumber = position.m_turnNumber;
+	ply.scorelessTurnsInARow = position.m_scorelessTurnsInARow;
+	ply.gameOver = position.m_gameOver;
+	ply.tilesInBag = position.m_tilesInBag;
+	ply.tilesOnRack = position.m_tilesOnRack;
+	ply.bag = position.m_bag;
+	ply.drawingOrder = position.m_drawingOrder;
+	ply.explanatoryNote = position.m_explanatoryNote;
+
+	return ply;
+}
+
+void Playout::commit(Ply &ply, bool maintainBoard)
+{
+	GamePosition &position = *m_position;
+
+	// what follows mirrors Game::commitCandidate and Game::addPosition
+	position.prepareForCommit();
+	const Move moveMade(position.m_moveMade);
+
+	const int *tilesOnRackFaced = 0;
+	if (position.m_currentPlayer != position.m_players.end())
+	{
+		const int next = (ply.currentPlayer + 1) % position.m_players.size();
+		if (m_hasFaced[next])
+			tilesOnRackFaced = &m_tilesOnRackFaced[next];
+	}
+
+	position.advanceTurn(true, tilesOnRackFaced);
+
+	// the new position is now the last one its player on turn faced
+	ply.facedIndex = position.m_playerOnTurn - position.m_players.begin();
+	ply.tilesOnRackFaced = m_tilesOnRackFaced[ply.facedIndex];
+	ply.hasFaced = m_hasFaced[ply.facedIndex];
+	m_tilesOnRackFaced[ply.facedIndex] = position.m_tilesOnRack;
+	m_hasFaced[ply.facedIndex] = true;
+
+	position.removeAllMoves();
+
+	if (!position.gameOver())
+		position.resetMoveMade();
+
+	position.makeMove(moveMade, maintainBoard, &ply.board);
+}
+
+void Playout::rewind(int depth)
+{
+	if (depth >= m_depth)
+		return;
+
+	GamePosition &position = *m_position;
+
+	for (int i = m_depth - 1; i >= depth; --i)
+	{
+		const Ply &ply = m_plies[i];
+		position.m_board.unmakeMove(ply.board);
+		m_tilesOnRackFaced[ply.facedIndex] = ply.tilesOnRackFaced;
+		m_hasFaced[ply.facedIndex] = ply.hasFaced;
+	}
+
+	// everything else is as it was before the earliest commit taken back
+	// and whose storage the next commit will reuse
+	Ply &ply = m_plies[depth];
+	for (unsigned int i = 0; i < ply.players.size(); ++i)
+	{
+		Player &player = position.m_players[i];
+		player.setRack(ply.players[i].rack);
+		player.setScore(ply.players[i].score);
+		player.setDrawnLetters(ply.players[i].drawnLetters);
+	}
+
+	position.m_currentPlayer = position.m_players.begin() + ply.currentPlayer;
+	position.m_playerOnTurn = position.m_players.begin() + ply.playerOnTurn;
+	position.m_moves.swap(ply.moves);
+	position.m_moveMade = ply.moveMade;
+	position.m_committedMove = ply.committedMove;
+	position.m_turnNumber = ply.turnNumber;
+	position.m_scorelessTurnsInARow = ply.scorelessTurnsInARow;
+	position.m_gameOver = ply.gameOver;
+	position.m_tilesInBag = ply.tilesInBag;
+	position.m_tilesOnRack = ply.tilesOnRack;
+	position.m_bag = ply.bag;
+	position.m_drawingOrder = ply.drawingOrder;
+	position.m_explanatoryNote = ply.explanatoryNote;
+
+	m_depth = depth;
+}
+
+////////
+
 HistoryLocation::HistoryLocation(int playerId, int turnNumber)
 	: m_playerId(playerId), m_turnNumber(turnNumber)
 {
@@ -93,8 +93,10 @@ public:
 	// ALSO GET COPIED!!!!!!!!!!!!!!!!!!!!!!
 	const GamePosition &operator=(const GamePosition &position);
 
-	// kibitz up to nmoves best moves; stored in move list
-	void kibitz(int nmoves = 10);
+	// kibitz up to nmoves best moves; stored in move list.
+	// If equityWindow is nonnegative, moves more than that far
+	// below the best are left out.
+	void kibitz(int nmoves = 10, double equityWindow = -1);
 
 	// get what's in the move list
 	const MoveList &moves() const;
@@ -178,7 +180,8 @@ public:
 	// back in the bag.
 	// If maintainBoard is false, the board can no longer be used
 	// with kibitzing capabilities.
-	void makeMove(const Move &move, bool maintainBoard = true);
+	// If undo is nonzero, the board's changes are saved in it.
+	void makeMove(const Move &move, bool maintainBoard = true, BoardUndo *undo = 0);
 
 	// Used when modifying the board without going through the motions,
 	// or preparing a freshly-loaded-from-file board for analysis
@@ -442,6 +445,14 @@ protected:
 
 	UVString m_explanatoryNote;
 
+	// incrementTurn() proper. If countTiles is true, tile counts
+	// are kept up to date as if from a history, in which the next
+	// player last faced a position with tilesOnRackFaced tiles on
+	// rack, or none at all if tilesOnRackFaced is zero.
+	bool advanceTurn(bool countTiles, const int *tilesOnRackFaced);
+
+	friend class Playout;
+
 	// Use this instead of m_bag.removeTiles(); if the bag
 	// doesn't contain the tiles to remove, it removes from
 	// non-current player racks if they have tiles and then refills.
@@ -646,6 +657,9 @@ public:
 	// all positions this player has been in
 	PositionList positionsFacedBy(int playerID) const;
 
+	// the last of positionsFacedBy(playerID), or 0 if there are none
+	const GamePosition *lastPositionFacedBy(int playerID) const;
+
 	// the next position after the current position
 	const GamePosition &nextPosition(bool *exists = 0) const;
 
@@ -916,6 +930,108 @@ inline void Game::setTitle(const UVString &title)
 	m_title = title;
 }
 
+// Commits moves on a position in place, saving what each commit
+// changes so that it can be taken back. Playouts use this to reuse
+// one position rather than copying a whole Game, history and all,
+// for every line they play out.
+class Playout
+{
+public:
+	Playout();
+
+	// Start playing out position, which must outlive the playout.
+	// history is the game position comes from; its tile counts
+	// are read here, so it need not outlive the playout.
+	void start(GamePosition *position, const History &history);
+
+	GamePosition &position();
+	const GamePosition &position() const;
+
+	// Commit the move made of the position as Game::commitCandidate
+	// would, but without adding a position to a history.
+	// If the game is over, does nothing.
+	void commitCandidate(bool maintainBoard = true);
+
+	// convenience to set move as move made and then commit it
+	void commitMove(const Move &move, bool maintainBoard = true);
+
+	// number of commits that can be taken back
+	int depth() const;
+
+	// take back commits until only depth of them remain
+	void rewind(int depth = 0);
+
+private:
+	// what a commit can change of a player
+	struct PlayerState
+	{
+		Rack rack;
+		int score;
+		Rack drawnLetters;
+	};
+
+	// the position as it was before a commit; moves are swapped
+	// out of the position rather than copied, as a commit clears
+	// them anyway
+	struct Ply
+	{
+		vector<PlayerState> players;
+		int currentPlayer;
+		int playerOnTurn;
+		MoveList moves;
+		Move moveMade;
+		Move committedMove;
+		int turnNumber;
+		int scorelessTurnsInARow;
+		bool gameOver;
+		int tilesInBag;
+		int tilesOnRack;
+
+		// only letter counts, so copying allocates nothing
+		Bag bag;
+		LetterString drawingOrder;
+		UVString explanatoryNote;
+		BoardUndo board;
+
+		// entry of m_tilesOnRackFaced that the commit replaced
+		int facedIndex;
+		int tilesOnRackFaced;
+		bool hasFaced;
+	};
+
+	GamePosition *m_position;
+
+	// per player index, tiles on rack in the position the player
+	// last faced; stands in for History::lastPositionFacedBy
+	vector<int> m_tilesOnRackFaced;
+	vector<char> m_hasFaced;
+
+	// kept between playouts so that their storage is reused
+	vector<Ply> m_plies;
+	int m_depth;
+
+	// save the position as it is into the next ply
+	Ply &savePly();
+
+	// commit the move made, saving the board's changes in ply
+	void commit(Ply &ply, bool maintainBoard);
+};
+
+inline GamePosition &Playout::position()
+{
+	return *m_position;
+}
+
+inline const GamePosition &Playout::position() const
+{
+	return *m_position;
+}
+
+inline int Playout::depth() const
+{
+	return m_depth;
+}
+
 }
 
 bool operator==(const Quackle::HistoryLocation &hl1, const Quackle::HistoryLocation &hl2);
@@ -16,6 +16,7 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <math.h>
@@ -35,11 +36,12 @@ using namespace std;
 using namespace Quackle;
 
 Generator::Generator()
+	: m_allPossiblePlaysUnpacked(false), m_kibitzLength(1), m_equityWindow(-1)
 {
 }
 
 Generator::Generator(const GamePosition &position)
-	: m_position(position)
+	: m_allPossiblePlaysUnpacked(false), m_kibitzLength(1), m_equityWindow(-1), m_position(position)
 {
 }
 
@@ -47,9 +49,20 @@ Generator::~Generator()
 {
 }
 
+// orders plays by equity, best first, and a heap of them so that its
+// front is the worst play
+bool Generator::betterRecordedMove(const RecordedMove &move1, const RecordedMove &move2)
+{
+	if (move1.equity == move2.equity)
+		return PackedMove::wordPosComparator(move2.move, move1.move);
+
+	return move1.equity > move2.equity;
+}
+
 void Generator::kibitz(int kibitzLength, int flags)
 {
 	// don't just record best move, unless kibitz length is one
+	m_kibitzLength = kibitzLength;
     setrecordall(kibitzLength > 1);
 
 	// perform actual kibitz
@@ -63,229 +76,294 @@ void Generator::kibitz(int kibitzLength, int flags)
 		return;
 	}
 
-	filterOutDuplicatePlays();
-
-	MoveList::sort(m_moveList, MoveList::Equity);
+	// m_moveList is a heap of at most kibitzLength plays; only
+	// those kept for the kibitz list are unpacked
+	sort_heap(m_moveList.begin(), m_moveList.end(), betterRecordedMove);
 
-	int i = 0;
-	MoveList::iterator end(m_moveList.end());
-    for (MoveList::iterator it = m_moveList.begin(); it != end; ++it, ++i)
+	const double threshold = m_moveList.front().equity - m_equityWindow;
+	const vector<RecordedMove>::const_iterator end(m_moveList.end());
+	for (vector<RecordedMove>::const_iterator it = m_moveList.begin(); it != end; ++it)
 	{
-		if (i >= kibitzLength)
+		if (m_equityWindow >= 0 && (*it).equity < threshold)
 			break;
 
-		m_kibitzList.push_back(*it);
+		m_kibitzList.push_back(unpack(*it));
 	}
 }
 
-void Generator::filterOutDuplicatePlays()
+const MoveList &Generator::allPossiblePlays()
 {
-	map<int, bool> oneTilePlayMap;
-	for (MoveList::iterator it = m_moveList.begin(); it != m_moveList.end();)
+	if (!m_allPossiblePlaysUnpacked)
 	{
-		LetterString usedTiles = (*it).usedTiles();
-		if (usedTiles.size() == 1)
-		{
-			const LetterString &tiles = (*it).tiles();
-			int actualTileIndex = 0;
-			for (LetterString::const_iterator letterIt = tiles.begin(); letterIt != tiles.end(); ++letterIt, ++actualTileIndex)
-				if ((*letterIt) != QUACKLE_PLAYED_THRU_MARK)
-					break;
+		m_allPossiblePlays.clear();
 
-			const int row = (*it).startrow + ((*it).horizontal? 0 : actualTileIndex);
-			const int column = (*it).startcol + ((*it).horizontal? actualTileIndex : 0);
-			int key = row + QUACKLE_MAXIMUM_BOARD_SIZE * column + (QUACKLE_MAXIMUM_BOARD_SIZE * QUACKLE_MAXIMUM_BOARD_SIZE) * String::front(usedTiles);
+		const vector<RecordedMove>::const_iterator end(m_moveList.end());
+		for (vector<RecordedMove>::const_iterator it = m_moveList.begin(); it != end; ++it)
+			m_allPossiblePlays.push_back(unpack(*it));
 
-			if (oneTilePlayMap.find(key) == oneTilePlayMap.end())
-			{
-				oneTilePlayMap[key] = true;
-				++it;
-			}
-			else
-			{
-				it = m_moveList.erase(it);
-			}
-		}
-		else
+		m_allPossiblePlaysUnpacked = true;
+	}
+
+	return m_allPossiblePlays;
+}
+
+Generator::RecordedMove Generator::record(const Move &move)
+{
+	if (PackedMove::canPack(move))
+		return RecordedMove(move, -1);
+
+	if (m_freeWholeMoves.empty())
+	{
+		m_wholeMoves.push_back(move);
+		return RecordedMove(move, m_wholeMoves.size() - 1);
+	}
+
+	const int whole = m_freeWholeMoves.back();
+	m_freeWholeMoves.pop_back();
+	m_wholeMoves[whole] = move;
+	return RecordedMove(move, whole);
+}
+
+Move Generator::unpack(const RecordedMove &recorded)
+{
+	Move ret(recorded.whole >= 0? m_wholeMoves[recorded.whole] : recorded.move.unpack(board()));
+	ret.equity = recorded.equity;
+	return ret;
+}
+
+void Generator::recordPendingMoves()
+{
+	if (m_pendingMoves.empty())
+		return;
+
+	board().scoreMoves(&m_pendingMoves[0], m_pendingMoves.size());
+
+	const MoveList::iterator end(m_pendingMoves.end());
+	for (MoveList::iterator it = m_pendingMoves.begin(); it != end; ++it)
+	{
+		(*it).equity = equity(*it);
+		recordMove(*it);
+	}
+
+	m_pendingMoves.clear();
+}
+
+void Generator::recordMove(const Move &move)
+{
+	if (MoveList::equityComparator(best, move))
+		best = move;
+
+	if (!m_recordall || isDuplicateOneTilePlay(move))
+		return;
+
+	if (m_equityWindow >= 0)
+	{
+		// best recorded equity only rises, so anything outside
+		// the window now stays outside it
+		if (m_moveList.empty() || move.equity > m_bestRecordedEquity)
+			m_bestRecordedEquity = move.equity;
+		else if (move.equity < m_bestRecordedEquity - m_equityWindow)
+			return;
+	}
+
+	if (static_cast<int>(m_moveList.size()) < m_kibitzLength)
+	{
+		m_moveList.push_back(record(move));
+		push_heap(m_moveList.begin(), m_moveList.end(), betterRecordedMove);
+	}
+	else if (betterRecordedMove(RecordedMove(move, -1), m_moveList.front()))
+	{
+		pop_heap(m_moveList.begin(), m_moveList.end(), betterRecordedMove);
+		if (m_moveList.back().whole >= 0)
+			m_freeWholeMoves.push_back(m_moveList.back().whole);
+		m_moveList.back() = record(move);
+		push_heap(m_moveList.begin(), m_moveList.end(), betterRecordedMove);
+	}
+}
+
+bool Generator::isDuplicateOneTilePlay(const Move &move)
+{
+	// a one-tile play is found once in each direction; keep the first
+	if (move.action != Move::Place)
+		return false;
+
+	const LetterString &tiles = move.tiles();
+	int actualTileIndex = -1;
+	int laid = 0;
+	for (int i = 0; i < static_cast<int>(tiles.length()); ++i)
+	{
+		if (tiles[i] != QUACKLE_PLAYED_THRU_MARK)
 		{
-			++it;
+			if (++laid > 1)
+				return false;
+			actualTileIndex = i;
 		}
 	}
+
+	if (actualTileIndex < 0)
+		return false;
+
+	// all designations of a blank on one square count as one play
+	const Letter letter = QUACKLE_ALPHABET_PARAMETERS->isBlankLetter(tiles[actualTileIndex])? QUACKLE_BLANK_MARK : tiles[actualTileIndex];
+	const int row = move.startrow + (move.horizontal? 0 : actualTileIndex);
+	const int column = move.startcol + (move.horizontal? actualTileIndex : 0);
+	const int key = (letter * QUACKLE_MAXIMUM_BOARD_SIZE + column) * QUACKLE_MAXIMUM_BOARD_SIZE + row;
+
+	if (m_oneTilePlays.test(key))
+		return true;
+
+	m_oneTilePlays.set(key);
+	m_oneTilePlayKeys.push_back(key);
+	return false;
+}
+
+// the number of tiles in the run of tiles, read as bits of a row or
+// column bitboard, that ends at square
+static int tilesEndingAt(uint64_t tiles, int square)
+{
+	// the highest gap at or below square, spread down to bit 0
+	uint64_t gaps = ~tiles & ((2ULL << square) - 1);
+	gaps |= gaps >> 1;
+	gaps |= gaps >> 2;
+	gaps |= gaps >> 4;
+	gaps |= gaps >> 8;
+	gaps |= gaps >> 16;
+	gaps |= gaps >> 32;
+	return square + 1 - gaddagPopcount(gaps);
 }
 
 void Generator::allCrosses()
 {
-	vector<int> vrows, vcols, hrows, hcols;
-
-	for (int i = 0; i < board().height(); i++) {
-		for (int j = 0; j < board().width(); j++) {
-			vrows.push_back(i);
-			vcols.push_back(j);
-			hrows.push_back(i);
-			hcols.push_back(j);
-		}
+	allCrosses(board());
+}
+
+void Generator::allCrosses(Board &board)
+{
+	for (int row = 0; row < board.height(); row++)
+		for (int col = 0; col < board.width(); col++)
+			updateVCross(board, row, col);
+
+	for (int row = 0; row < board.height(); row++)
+		for (int col = 0; col < board.width(); col++)
+			updateHCross(board, row, col);
+}
+
+void Generator::updateVCross(Board &board, int row, int col)
+{
+	if (board.isOccupied(row, col)) {
+		board.setVCross(row, col, LetterBitset());
+		return;
 	}
 
-	// check the appropriate crosses
-	for (unsigned int i = 0; i < vrows.size(); i++) {
-		int row = vrows[i];
-		int col = vcols[i];
+	// find the top of the word above this square, then read
+	// prefix and suffix front to back
+	int top = row;
+	while (top > 0 && board.isOccupied(top - 1, col))
+		top--;
 
-		if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-			board().setVCross(row, col, LetterBitset());
-		}
-		else { 
-			LetterString pre; 
-			if (row > 0) {
-				for (int i = row - 1; i >= 0; i--) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col))) {
-						i = -1;
-					}
-					else {
-						LetterString newpre;
-						newpre += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(i, col));
-						newpre += pre;
-						pre = newpre;
-					}
-				}
-			}
+	LetterString pre;
+	for (int i = top; i < row; i++)
+		pre += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board.letter(i, col));
 
-			LetterString suf;
-			if (row < board().height() - 1) {
-				for (int i = row + 1; i < board().height(); i++) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col))) {
-						i = board().height();
-					}
-					else {
-						suf += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(i, col));
-					}
-				}
-			}
+	LetterString suf;
+	for (int i = row + 1; i < board.height() && board.isOccupied(i, col); i++)
+		suf += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board.letter(i, col));
 
 #ifdef DEBUG_GENERATOR
-			UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(pre) << " / " << QUACKLE_ALPHABET_PARAMETERS->userVisible(suf) << endl;
+	UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(pre) << " / " << QUACKLE_ALPHABET_PARAMETERS->userVisible(suf) << endl;
 #endif
 
-			if (pre.empty() && suf.empty()) {
-				board().setVCross(row, col, LetterBitset().set());
-			}
-			else {
-				board().setVCross(row, col, fitbetween(pre, suf));
-			}
+	if (pre.empty() && suf.empty()) {
+		board.setVCross(row, col, LetterBitset().set());
+	}
+	else {
+		board.setVCross(row, col, fitbetween(pre, suf));
+	}
+}
 
-#ifdef DEBUG_GENERATOR
-			UVcout << "board().vcross[" << row << "][" << col << "] = " << cross2string(board().vcross(row, col)) << endl;
-#endif
-		}
+void Generator::updateHCross(Board &board, int row, int col)
+{
+	if (board.isOccupied(row, col)) {
+		board.setHCross(row, col, LetterBitset());
+		return;
 	}
 
-	for (unsigned int i = 0; i < hrows.size(); i++) {
-		int row = hrows[i];
-		int col = hcols[i];
+	int left = col;
+	while (left > 0 && board.isOccupied(row, left - 1))
+		left--;
 
-		if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-			board().setHCross(row, col, LetterBitset());
-		}
-		else { 
-			LetterString pre;
-			if (col > 0) {
-				for (int i = col - 1; i >= 0; i--) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i))) {
-						i = -1;
-					}
-					else {
-						LetterString newpre;
-						newpre += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(row, i));
-						newpre += pre;
-						pre = newpre;
-					}
-				}
-			}
+	LetterString pre;
+	for (int i = left; i < col; i++)
+		pre += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board.letter(row, i));
 
-			LetterString suf;
-			if (col < board().width() - 1) {
-				for (int i = col + 1; i < board().width(); i++) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i))) {
-						i = board().width();
-					}
-					else {
-						suf += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(row, i));
-					}
-				}
-			}
-			if (pre.empty() && suf.empty()) {
-				board().setHCross(row, col, LetterBitset().set());
-			}
-			else {
-				board().setHCross(row, col, fitbetween(pre, suf));
-			}
+	LetterString suf;
+	for (int i = col + 1; i < board.width() && board.isOccupied(row, i); i++)
+		suf += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board.letter(row, i));
 
 #ifdef DEBUG_GENERATOR
-			UVcout << "board().hcross[" << row << "][" << col << "] = " << cross2string(board().hcross(row, col)) << endl;
+	UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(pre) << " / " << QUACKLE_ALPHABET_PARAMETERS->userVisible(suf) << endl;
 #endif
-		}
+
+	if (pre.empty() && suf.empty()) {
+		board.setHCross(row, col, LetterBitset().set());
+	}
+	else {
+		board.setHCross(row, col, fitbetween(pre, suf));
 	}
 }
 
 void Generator::makeMove(const Move &move, bool regenerateCrosses)
 {
-	if (move.action != Move::Place)
-		return;
+	makeMove(board(), move, regenerateCrosses);
+}
 
-	if (!regenerateCrosses)
+void Generator::makeMove(Board &board, const Move &move, bool regenerateCrosses, BoardUndo *undo)
+{
+	if (move.action != Move::Place || !regenerateCrosses)
 	{
-		board().makeMove(move);
+		board.makeMove(move, undo);
 		return;
 	}
 
-	// mark which squares need their crosses checked
-	vector<int> hrows;
-	vector<int> hcols;
-	vector<int> vrows;
-	vector<int> vcols;
-	hrows.reserve(2 * QUACKLE_MAXIMUM_BOARD_SIZE);
-	hcols.reserve(2 * QUACKLE_MAXIMUM_BOARD_SIZE);
-	vrows.reserve(2 * QUACKLE_MAXIMUM_BOARD_SIZE);
-	vcols.reserve(2 * QUACKLE_MAXIMUM_BOARD_SIZE);
+	// mark which squares need their crosses checked; a play touches
+	// at most two squares per tile plus its two ends
+	int hrows[2 * QUACKLE_MAXIMUM_BOARD_SIZE + 2];
+	int hcols[2 * QUACKLE_MAXIMUM_BOARD_SIZE + 2];
+	int vrows[2 * QUACKLE_MAXIMUM_BOARD_SIZE + 2];
+	int vcols[2 * QUACKLE_MAXIMUM_BOARD_SIZE + 2];
+	int hcount = 0;
+	int vcount = 0;
 
 	if (move.horizontal) {
 		int row = move.startrow;
 		int endcol = move.startcol + move.tiles().length() - 1;
 
 		if (move.startcol > 0) {
-			hrows.push_back(row);
-			hcols.push_back(move.startcol - 1);
+			hrows[hcount] = row;
+			hcols[hcount++] = move.startcol - 1;
 		}
 
-		if (endcol < board().width() - 1) {
-			hrows.push_back(row);
-			hcols.push_back(endcol + 1); 
+		if (endcol < board.width() - 1) {
+			hrows[hcount] = row;
+			hcols[hcount++] = endcol + 1;
 		}
 
 		for (int col = move.startcol; col <= endcol; col++) {
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-				int upempty = -1;
-				for (int hookrow = row - 1; hookrow >= 0; hookrow--) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(hookrow, col))) {
-						upempty = hookrow;
-						hookrow = -1;
-					}
-				} 
+			if (!board.isOccupied(row, col)) {
+				int upempty = row - 1;
+				while (upempty >= 0 && board.isOccupied(upempty, col))
+					upempty--;
 				if (upempty >= 0) {
-					vrows.push_back(upempty);
-					vcols.push_back(col);
+					vrows[vcount] = upempty;
+					vcols[vcount++] = col;
 				}
 
-				int downempty = board().height();
-				for (int hookrow = row + 1; hookrow < board().height(); hookrow++) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(hookrow, col))) {
-						downempty = hookrow;
-						hookrow = board().height();
-					}
-				}
-				if (downempty < board().height()) {
-					vrows.push_back(downempty);
-					vcols.push_back(col);
+				int downempty = row + 1;
+				while (downempty < board.height() && board.isOccupied(downempty, col))
+					downempty++;
+				if (downempty < board.height()) {
+					vrows[vcount] = downempty;
+					vcols[vcount++] = col;
 				}
 			}
 		}
@@ -295,150 +373,55 @@ void Generator::makeMove(const Move &move, bool regenerateCrosses)
 		int endrow = move.startrow + move.tiles().length() - 1;
 
 		if (move.startrow > 0) {
-			vrows.push_back(move.startrow - 1);
-			vcols.push_back(col);
+			vrows[vcount] = move.startrow - 1;
+			vcols[vcount++] = col;
 		}
 
-		if (endrow < board().height() - 1) {
-			vrows.push_back(endrow + 1);
-			vcols.push_back(col); 
+		if (endrow < board.height() - 1) {
+			vrows[vcount] = endrow + 1;
+			vcols[vcount++] = col;
 		}
 
 		for (int row = move.startrow; row <= endrow; row++) {
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-				int upempty = -1;
-				for (int hookcol = col - 1; hookcol >= 0; hookcol--) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, hookcol))) {
-						upempty = hookcol;
-						hookcol = -1;
-					}
-				} 
+			if (!board.isOccupied(row, col)) {
+				int upempty = col - 1;
+				while (upempty >= 0 && board.isOccupied(row, upempty))
+					upempty--;
 				if (upempty >= 0) {
-					hrows.push_back(row);
-					hcols.push_back(upempty);
+					hrows[hcount] = row;
+					hcols[hcount++] = upempty;
 				}
 
-				int downempty = board().width();
-				for (int hookcol = col + 1; hookcol < board().width(); hookcol++) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, hookcol))) {
-						downempty = hookcol;
-						hookcol = board().width();
-					}
-				}
-				if (downempty < board().width()) {
-					hrows.push_back(row);
-					hcols.push_back(downempty);
+				int downempty = col + 1;
+				while (downempty < board.width() && board.isOccupied(row, downempty))
+					downempty++;
+				if (downempty < board.width()) {
+					hrows[hcount] = row;
+					hcols[hcount++] = downempty;
 				}
 			}
 		}
 	}
 
-	board().makeMove(move);
+	board.makeMove(move, undo);
 
 	// check the appropriate crosses
-	for (unsigned int i = 0; i < vrows.size(); i++) {
-		int row = vrows[i];
-		int col = vcols[i];
-		if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-			board().setVCross(row, col, LetterBitset());
-		}
-		else { 
-			LetterString pre;
-			if (row > 0) {
-				for (int i = row - 1; i >= 0; i--) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col))) {
-						i = -1;
-					}
-					else {
-						LetterString newpre;
-						newpre += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(i, col));
-						newpre += pre;
-						pre = newpre;
-					}
-				}
-			}
-			LetterString suf;
-			if (row < board().height() - 1) {
-				for (int i = row + 1; i < board().height(); i++) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col))) {
-						i = board().height();
-					}
-					else {
-						suf += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(i, col));
-					}
-				}
-			}
-
-#ifdef DEBUG_GENERATOR
-			UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(pre) << " / " << QUACKLE_ALPHABET_PARAMETERS->userVisible(suf) << endl;
-#endif
-
-			if ((pre.empty()) && (suf.empty())) {
-				board().setVCross(row, col, LetterBitset().set());
-			}
-			else {
-				board().setVCross(row, col, fitbetween(pre, suf));
-			}
-
-#ifdef DEBUG_GENERATOR
-			UVcout << "board().vcross[" << row << "][" << col << "] = " << cross2string(board().vcross(row, col)) << endl;
-#endif
-		}
+	for (int i = 0; i < vcount; i++)
+	{
+		if (undo)
+			board.saveVCross(vrows[i], vcols[i], *undo);
+		updateVCross(board, vrows[i], vcols[i]);
 	}
 
-	for (unsigned int i = 0; i < hrows.size(); i++) {
-		int row = hrows[i];
-		int col = hcols[i];
-
-		if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-			board().setHCross(row, col, LetterBitset());
-		}
-		else { 
-			LetterString pre; 
-			if (col > 0) {
-				for (int i = col - 1; i >= 0; i--) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i))) {
-						i = -1;
-					}
-					else {
-						LetterString newpre;
-						newpre += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(row, i));
-						newpre += pre;
-						pre = newpre;
-					}
-				}
-			}
-			LetterString suf;
-			if (col < board().width() - 1) {
-				for (int i = col + 1; i < board().width(); i++) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i))) {
-						i = board().width();
-					}
-					else {
-						suf += QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(row, i));
-					}
-				}
-			}
-
-#ifdef DEBUG_GENERATOR
-			UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(pre) << " / " << QUACKLE_ALPHABET_PARAMETERS->userVisible(suf) << endl;
-#endif
-
-			if ((pre.empty()) && (suf.empty())) {
-				board().setHCross(row, col, LetterBitset().set());
-			}
-			else {
-				board().setHCross(row, col, fitbetween(pre, suf));
-			}
-
-#ifdef DEBUG_GENERATOR
-			UVcout << "board().hcross[" << row << "][" << col << "] = " << cross2string(board().hcross(row, col)) << endl;
-#endif
-		}
+	for (int i = 0; i < hcount; i++)
+	{
+		if (undo)
+			board.saveHCross(hrows[i], hcols[i], *undo);
+		updateHCross(board, hrows[i], hcols[i]);
 	}
 }
 
-void Generator::readFromDawg(int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability) const
+void Generator::readFromDawg(int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability)
 {
 	QUACKLE_LEXICON_PARAMETERS->dawgAt(index, p, letter, t, lastchild, british, playability);
 }
@@ -526,10 +509,23 @@ LetterBitset Generator::gaddagFitbetween(const LetterString &pre, const LetterSt
 
 LetterBitset Generator::fitbetween(const LetterString &pre, const LetterString &suf)
 {
- 	if (QUACKLE_LEXICON_PARAMETERS->hasGaddag()) {
- 		return gaddagFitbetween(pre, suf);
-	}
+	CrossCache *cache = QUACKLE_LEXICON_PARAMETERS->crossCache();
+
+	LetterBitset crosses;
+	if (cache->find(pre, suf, crosses))
+		return crosses;
 
+ 	if (QUACKLE_LEXICON_PARAMETERS->hasGaddag())
+ 		crosses = gaddagFitbetween(pre, suf);
+	else
+		crosses = dawgFitbetween(pre, suf);
+
+	cache->store(pre, suf, crosses);
+	return crosses;
+}
+
+LetterBitset Generator::dawgFitbetween(const LetterString &pre, const LetterString &suf)
+{
 	//UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(pre) << "_" <<
 	//          QUACKLE_ALPHABET_PARAMETERS->userVisible(suf) << endl;
 
@@ -625,7 +621,7 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 			leftrow += pos - 1;
 		}
 
-		if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(currow, curcol))) {
+		if (board().isOccupied(currow, curcol)) {
 			L = QUACKLE_PLAYED_THRU_MARK;
 		}
 
@@ -638,7 +634,7 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 		bool atboardedge = false;
 
 		if ((leftcol >= 0) && (leftrow >= 0)) {
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(currow, curcol)) && QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(leftrow, leftcol))) {
+			if (!board().isOccupied(currow, curcol) && board().isOccupied(leftrow, leftcol)) {
 				roomtoleft = false;
 			}
 
@@ -646,7 +642,7 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 				roomtoleft = false;
 			}
 
-			if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(leftrow, leftcol))) {
+			if (board().isOccupied(leftrow, leftcol)) {
 				emptyleft = false;
 			}
 		}
@@ -669,16 +665,8 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 			}
 
 			move.horizontal = m_gordonhoriz;
-			move.score = board().score(move, &move.isBingo);
-			move.equity = equity(move);
-
-			if (m_recordall) {
-				m_moveList.push_back(move);
-			}
 
-			if (MoveList::equityComparator(best, move)) {
-				best = move;
-			}
+			m_pendingMoves.push_back(move);
 			// UVcout << "found a move: " << move << " score: " << move.score << ", equity: " << move.equity << 
 			// " outputted by leftmoving loop" << endl;
 		}
@@ -729,7 +717,7 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 			rightrow += pos + 1;
 		}
 
-		if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(currow, curcol))) {
+		if (board().isOccupied(currow, curcol)) {
 			word += QUACKLE_PLAYED_THRU_MARK;
 		}
 		else {
@@ -742,7 +730,7 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 		// UVcout << "rightsquare: " << (char)(rightcol + 'A') << rightrow + 1 << endl;
 
 		if ((rightcol <= board().width() - 1) && (rightrow <= board().height() - 1)) {
-			if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(rightrow, rightcol))) {
+			if (board().isOccupied(rightrow, rightcol)) {
 				roomtoright = false;
 				// UVcout << "can't record " << word << " here because of the " << board().letter(rightrow, rightcol) << endl;
 			}
@@ -773,16 +761,8 @@ void Generator::gordongoon(int pos, char L, LetterString word, const GaddagNode
 			}
 
 			move.horizontal = m_gordonhoriz;
-			move.score = board().score(move, &move.isBingo);
-			move.equity = equity(move);
-
-			if (m_recordall) {
-				m_moveList.push_back(move);
-			}
 
-			if (MoveList::equityComparator(best, move)) {
-				best = move;
-			}
+			m_pendingMoves.push_back(move);
 			// UVcout << "found a move: " << move << " score: " << move.score << ", equity: " << move.equity << 
 			//      " outputted by rightmoving loop" << endl;
 		}
@@ -819,7 +799,7 @@ void Generator::gordongen(int pos, const LetterString &word, const GaddagNode *n
 		cross = board().hcross(currow, curcol);
 	}
 
-	if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(currow, curcol))) {
+	if (board().isOccupied(currow, curcol)) {
 		// UVcout << "gordongen sez a letter (" << board().letter(currow, curcol) << ") already on this square" << endl;
 
 		Letter boardc = QUACKLE_ALPHABET_PARAMETERS->clearBlankness(board().letter(currow, curcol));
@@ -831,45 +811,34 @@ void Generator::gordongen(int pos, const LetterString &word, const GaddagNode *n
 	}
 
 	else {
-		for (const GaddagNode* child = node->firstChild(); child; child = child->nextSibling()) {
-			Letter childLetter = child->letter();
-
-			if ((m_counts[childLetter] <= 0) 
-					|| !cross.test(childLetter - QUACKLE_FIRST_LETTER)) {
-				continue;
-			}
+		// cross sets hold no separator bit, so neither does this
+		const uint64_t allowed = node->childMask() & cross.to_ullong();
 
-			if (childLetter == QUACKLE_GADDAG_SEPARATOR) {
-				// UVcout << "ran into a delimiter" << endl;
-				break;
-			}
+		for (uint64_t letters = allowed & m_rackMask; letters; letters &= letters - 1) {
+			const uint64_t bit = letters & (~letters + 1);
+			const GaddagNode *child = node->childForBit(bit);
+			Letter childLetter = child->letter();
 
-			m_counts[childLetter]--;
+			if (--m_counts[childLetter] == 0)
+				m_rackMask &= ~bit;
 			m_laid++;
 			// UVcout << "    yeah that'll work" << endl;
 			gordongoon(pos, childLetter, word, child);
-			m_counts[childLetter]++;
+			if (m_counts[childLetter]++ == 0)
+				m_rackMask |= bit;
 			m_laid--;
-
 		}
+
 		if (m_counts[QUACKLE_BLANK_MARK] >= 1) {
-			for (const GaddagNode* child = node->firstChild(); child; child = child->nextSibling()) {
+			for (uint64_t letters = allowed; letters; letters &= letters - 1) {
+				const GaddagNode *child = node->childForBit(letters & (~letters + 1));
 				Letter childLetter = child->letter();
-				// UVcout << "childLetter is " << (char)(arcc + 'A') << endl;
-
-				if (childLetter == QUACKLE_GADDAG_SEPARATOR) {
-					// UVcout << "ran into a delimiter" << endl;
-					break;
-				}
 
-				if (cross.test(childLetter - QUACKLE_FIRST_LETTER)) {
-					m_counts[QUACKLE_BLANK_MARK]--;
-					m_laid++;
-					// UVcout << "    yeah that'll work" << endl;
-					gordongoon(pos, QUACKLE_ALPHABET_PARAMETERS->setBlankness(childLetter), word, child);
-					m_counts[QUACKLE_BLANK_MARK]++;
-					m_laid--;
-				}
+				m_counts[QUACKLE_BLANK_MARK]--;
+				m_laid++;
+				gordongoon(pos, QUACKLE_ALPHABET_PARAMETERS->setBlankness(childLetter), word, child);
+				m_counts[QUACKLE_BLANK_MARK]++;
+				m_laid--;
 			}
 		}
 	}
@@ -915,7 +884,7 @@ void Generator::extendright(const LetterString &partial, int i,
 	UVcout << "extendright(" << QUACKLE_ALPHABET_PARAMETERS->userVisible(partial) << ", " << i << ", " << counts2string() << ", " << rowpos << ", " << colpos << ", " << horizontal <<  ")" << endl;
 #endif
 
-	if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(rowpos, colpos))) {
+	if (!board().isOccupied(rowpos, colpos)) {
 		if (m_counts[c] >= 1) {
 			LetterBitset cross;
 			if (horizontal) {
@@ -928,7 +897,7 @@ void Generator::extendright(const LetterString &partial, int i,
 				if (t) {
 					bool couldend = true;
 					if (dirpos < edgeDirpos) {
-						if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(rownext, colnext))) {
+						if (board().isOccupied(rownext, colnext)) {
 							couldend = false;
 						}
 					}
@@ -957,13 +926,7 @@ void Generator::extendright(const LetterString &partial, int i,
 						
 						if (1 || !ignore)
 						{
-							if (m_recordall) {
-								m_moveList.push_back(move);
-							}
-
-							if (MoveList::equityComparator(best, move)) {
-								best = move;
-							}
+							recordMove(move);
 
 #ifdef DEBUG_GENERATOR
 							UVcout << "found a move: " << move << " laid: " << m_laid << ", score: " << move.score << ", equity: " << move.equity << endl;
@@ -993,7 +956,7 @@ void Generator::extendright(const LetterString &partial, int i,
 				if (t) {
 					bool couldend = true;
 					if (dirpos < edgeDirpos) {
-						if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(rownext, colnext))) {
+						if (board().isOccupied(rownext, colnext)) {
 							couldend = false;
 						}
 					}
@@ -1019,13 +982,7 @@ void Generator::extendright(const LetterString &partial, int i,
 																								
 						if (1 || !ignore)
 						{
-							if (m_recordall) { 
-								m_moveList.push_back(move);
-							}
-
-							if (MoveList::equityComparator(best, move)) {
-								best = move;
-							}
+							recordMove(move);
 #ifdef DEBUG_GENERATOR
 							UVcout << "found a move: " << move << " laid: " << m_laid << ", score: " << move.score << ", equity: " << move.equity << endl;
 
@@ -1067,7 +1024,7 @@ void Generator::extendright(const LetterString &partial, int i,
 				UVcout << "  next square is " << board().letter(rownext, colnext) << endl;
 #endif
 
-				if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(rownext, colnext))) {
+				if (!board().isOccupied(rownext, colnext)) {
 					endofthrough = true;
 #ifdef DEBUG_GENERATOR
 					UVcout << "   woohoo!  next square is empty" << endl;
@@ -1111,13 +1068,7 @@ void Generator::extendright(const LetterString &partial, int i,
 					if (1 || !ignore)
 					{
 						
-						if (m_recordall) {
-							m_moveList.push_back(move);
-						}
-
-						if (MoveList::equityComparator(best, move)) {
-							best = move;
-						}
+						recordMove(move);
 
 #ifdef DEBUG_GENERATOR
 						UVcout << "found a move: " << move << " which has equity " << move.equity << endl;
@@ -1185,6 +1136,11 @@ void Generator::leftpart(const LetterString &partial, int i, int limit,
 void Generator::setupCounts(const LetterString &letters)
 {
 	String::counts(letters, m_counts);
+
+	m_rackMask = 0;
+	for (Letter letter = QUACKLE_FIRST_LETTER; letter < QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE; ++letter)
+		if (m_counts[letter] > 0)
+			m_rackMask |= GaddagNode::letterBit(letter);
 }
 
 double Generator::equity(const Move &move) const
@@ -1198,48 +1154,31 @@ Move Generator::generate()
 	UVcout << "generate called" << endl;
 #endif
 
+	const uint64_t squares = (1ULL << board().width()) - 1;
+
 	for (int row = 0; row < board().height(); row++) {
-		for (int col = 0; col < board().width(); col++) {
+		const uint64_t tiles = board().rowTiles(row);
+		const uint64_t above = row > 0? board().rowTiles(row - 1) : 0;
 
-			// generate horizontal plays
+		// Plays are anchored at the first tile of each run of tiles
+		// and at squares with nothing before them whose crosses rule
+		// something out. Squares are taken left to right, horizontal
+		// first.
+		const uint64_t horizontalAnchors = squares & ~(tiles << 1);
+		const uint64_t verticalAnchors = squares & ~above;
 
-			// what defines an anchor square?
+		for (uint64_t candidates = horizontalAnchors | verticalAnchors; candidates; candidates &= candidates - 1) {
+			const uint64_t bit = candidates & (~candidates + 1);
+			const int col = gaddagPopcount(bit - 1);
 
-			bool anchor = false;
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col)) && !board().vcross(row, col).all()) {
-				if (col == 0) {
-					anchor = true;
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col - 1))) {
-					anchor = true;
-				}
-			}
-			else if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-				if (col == 0) {
-					anchor = true;
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col - 1))) {
-					anchor = true;
-				}
-			}
-
-			if (anchor) {
+			if ((horizontalAnchors & bit) && ((tiles & bit) || !board().vcross(row, col).all())) {
 				int k = 0;
-				for (int i = col - 1; i >= 0; i--)
-				{
-					// UVcout << "board().vcross[" << row << "][" << i << "] = " << board().vcross(row, i) << endl;
-					
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i)) && board().vcross(row, i).all()) {
-						if (i == 0) {
-							k++;
-						}
-						else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i - 1))) {
-							k++;
-						}
-					}
-					else {
-						i = -1;
-					}
+				for (int i = col - 1; i >= 0; i--) {
+					if (board().isOccupied(row, i) || !board().vcross(row, i).all())
+						break;
+					if (i > 0 && board().isOccupied(row, i - 1))
+						break;
+					k++;
 				}
 
 #ifdef DEBUG_GENERATOR
@@ -1251,43 +1190,14 @@ Move Generator::generate()
 				leftpart(LetterString(), 1, k, row, col, 0, true);
 			}
 
-			// generate vertical plays
-
-			// what defines an anchor square?
-
-			anchor = false;
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col)) && !board().hcross(row, col).all()) {
-				if (row == 0) {
-					anchor = true;
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row - 1, col))) {
-					anchor = true;
-				}
-			}
-			else if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-				if (row == 0) {
-					anchor = true;
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row - 1, col))) {
-					anchor = true;
-				}
-			}
-
-			if (anchor) {
+			if ((verticalAnchors & bit) && ((tiles & bit) || !board().hcross(row, col).all())) {
 				int k = 0;
 				for (int i = row - 1; i >= 0; i--) {
-					// UVcout << "board().vcross[" << row << "][" << i << "] = " << board().vcross(row, i) << endl;
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col)) && board().hcross(i, col).all()) {
-						if (i == 0) {
-							k++;
-						}
-						else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i - 1, col))) {
-							k++;
-						}
-					}
-					else {
-						i = -1;
-					}
+					if (board().isOccupied(i, col) || !board().hcross(i, col).all())
+						break;
+					if (i > 0 && board().isOccupied(i - 1, col))
+						break;
+					k++;
 				}
 
 #ifdef DEBUG_GENERATOR
@@ -1307,66 +1217,37 @@ Move Generator::generate()
 // TODO GET RID OF CODE DUPLICATION
 Move Generator::gordongenerate()
 {
-	for (int row = 0; row < board().height(); row++) {
-		for (int col = 0; col < board().width(); col++) {
-
-			// generate horizontal plays
-			// what defines an anchor square?
-			bool anchor = false;
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col)) && !board().vcross(row, col).all()) {
-				if (col == 0) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col + 1))) {
-						anchor = true;
-					}
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col - 1))) {
-					if (col == board().width() - 1) {
-						anchor = true;
-					}
-					else {
-						if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col + 1))) {
-							anchor = true;
-						}
-					}
-				}
-			}
-			else if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-				if (col == board().width() - 1) {
-					anchor = true;
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col + 1))) {
-					anchor = true;
-				}
-			}
+	const uint64_t squares = (1ULL << board().width()) - 1;
 
-			if (anchor) {
-				int k = 0;
-				for (int i = col; i >= 0; i--) { // skip over filled sqs
-					if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i))) {
-						k++;
-					} else {
-						i = -1;
-					}
-				}
+	for (int row = 0; row < board().height(); row++) {
+		const uint64_t tiles = board().rowTiles(row);
+		const uint64_t above = row > 0? board().rowTiles(row - 1) : 0;
+		const uint64_t below = row < board().height() - 1? board().rowTiles(row + 1) : 0;
+
+		// Horizontal plays are anchored at the last tile of each run of
+		// tiles and at squares with no tile either side whose vertical
+		// crosses rule something out; vertical ones likewise, going
+		// down. Squares are taken left to right, horizontal first.
+		const uint64_t horizontalTiles = tiles & ~(tiles >> 1);
+		const uint64_t horizontalSquares = squares & ~tiles & ~(tiles << 1) & ~(tiles >> 1);
+		const uint64_t verticalTiles = tiles & ~below;
+		const uint64_t verticalSquares = squares & ~tiles & ~above & ~below;
+
+		for (uint64_t candidates = horizontalTiles | horizontalSquares | verticalTiles | verticalSquares; candidates; candidates &= candidates - 1) {
+			const uint64_t bit = candidates & (~candidates + 1);
+			const int col = gaddagPopcount(bit - 1);
+
+			if ((horizontalTiles & bit) || ((horizontalSquares & bit) && !board().vcross(row, col).all())) {
+				// skip over filled squares, then count the free
+				// squares to their left
+				int k = tilesEndingAt(tiles, col);
 				for (int i = col - k - 1; i >= 0; i--) {
-					// UVcout << "board().vcross[" << row << "][" << i << "] = " << board().vcross(row, i) << endl;
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i)) && board().vcross(row, i).all()) {
-						if (i == 0) {
-							k++;
-						}
-						else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, i - 1))) {
-							k++;
-						}
-					}
-					else {
-						i = -1;
-					}
+					if (board().isOccupied(row, i) || !board().vcross(row, i).all())
+						break;
+					if (i > 0 && board().isOccupied(row, i - 1))
+						break;
+					k++;
 				}
-				// UVcout << "Apparently there are " << k << " empty spots to our left" << endl;
-				// leftpart("", 1, k, row, col, 0, true);
-
-				// UVcout << "looking horizontally with the " << board().letter(row, col) <<
-				//         " at " << row + 1 << (char)(col + 'A') << endl;
 
 				m_anchorrow = row;
 				m_anchorcol = col;
@@ -1374,75 +1255,27 @@ Move Generator::gordongenerate()
 				m_laid = 0;
 				m_leftlimit = k;
 				gordongen(0, LetterString(), QUACKLE_LEXICON_PARAMETERS->gaddagRoot());
+				recordPendingMoves();
 			}
 
-			// generate vertical plays
-			// what defines an anchor square?
-
-			anchor = false;
-			if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col)) && !board().hcross(row, col).all()) {
-				if (row == 0) {
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row + 1, col))) {
-						anchor = true;
-					}
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row - 1, col))) {
-					if (row == board().height() - 1) {
-						anchor = true;
-					}
-					else {
-						if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row + 1, col))) {
-							anchor = true;
-						}
-					}
-				}
-			}
-			else if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row, col))) {
-				if (row == board().height() - 1) {
-					anchor = true;
-				}
-				else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(row + 1, col))) {
-					anchor = true;
-				}
-			}
-
-			if (anchor) {
-				int k = 0;
-				for (int i = row; i >= 0; i--) {
-					if (QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col))) {
-						k++;
-					} else {
-						i = -1;
-					}
-				}
+			if ((verticalTiles & bit) || ((verticalSquares & bit) && !board().hcross(row, col).all())) {
+				const uint64_t columnTiles = board().columnTiles(col);
+				int k = tilesEndingAt(columnTiles, row);
 				for (int i = row - k - 1; i >= 0; i--) {
-					// UVcout << "board().vcross[" << row << "][" << i << "] = " << board().vcross(row, i) << endl;
-					if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i, col)) && board().hcross(i, col).all()) {
-						if (i == 0) {
-							k++;
-						}
-						else if (!QUACKLE_ALPHABET_PARAMETERS->isSomeLetter(board().letter(i - 1, col))) {
-							k++;
-						}
-					}
-					else {
-						i = -1;
-					}
+					if (board().isOccupied(i, col) || !board().hcross(i, col).all())
+						break;
+					if (i > 0 && board().isOccupied(i - 1, col))
+						break;
+					k++;
 				}
 
-				// UVcout << "Apparently there are " << k << " empty spots to our left" << endl;
-				// leftpart("", 1, k, row, col, 0, false);
-
-				// UVcout << "looking vertically with the " << board().letter(row, col) <<
-				//         " at " << row + 1 << (char)(col + 'A') << endl;
-
 				m_anchorrow = row;
 				m_anchorcol = col;
 				m_gordonhoriz = false;
 				m_laid = 0;
 				m_leftlimit = k;
 				gordongen(0, LetterString(), QUACKLE_LEXICON_PARAMETERS->gaddagRoot());
-
+				recordPendingMoves();
 			}
 		}
 	}
@@ -1620,11 +1453,7 @@ Move Generator::exchange()
 
 		if (throwmap.find(move.tiles()) == throwmap.end())
 		{
-			if (m_recordall)
-				m_moveList.push_back(move);
-
-			if (MoveList::equityComparator(best, move)) 
-				best = move;
+			recordMove(move);
 
 			throwmap[move.tiles()] = true;
 		}
@@ -1637,6 +1466,14 @@ Move Generator::findstaticbest(bool canExchange)
 {
 	best = Move::createPassMove();
 	m_moveList.clear();
+	m_wholeMoves.clear();
+	m_freeWholeMoves.clear();
+	m_allPossiblePlaysUnpacked = false;
+
+	// only the few bits set last time need clearing
+	for (vector<int>::const_iterator it = m_oneTilePlayKeys.begin(); it != m_oneTilePlayKeys.end(); ++it)
+		m_oneTilePlays.reset(*it);
+	m_oneTilePlayKeys.clear();
 
 	setupCounts(rack().tiles());
 
@@ -1666,7 +1503,7 @@ Move Generator::findstaticbest(bool canExchange)
 		exchange();
 
 	if (m_moveList.empty())
-		m_moveList.push_back(best);
+		m_moveList.push_back(record(best));
 
 	return best;
 }
@@ -1798,19 +1635,13 @@ Move Generator::anagram()
 			if (move.startcol < 0)
 				continue;
 
-			move.score = board().score(move, &move.isBingo);
-
-			move.equity = equity(move);
-			// UVcout << move << " has equity " << move.equity << endl;
-
-			if (m_recordall)
-				m_moveList.push_back(move);
-
-			if (MoveList::equityComparator(best, move)) 
-				best = move;
+			m_pendingMoves.push_back(move);
 		}
 	}
 
+	// all along the start row
+	recordPendingMoves();
+
 	return best;
 }
 
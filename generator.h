@@ -19,11 +19,13 @@
 #ifndef QUACKLE_GENERATOR_H
 #define QUACKLE_GENERATOR_H
 
+#include <bitset>
 #include <vector>
 
 #include "alphabetparameters.h"
 #include "game.h"
 #include "move.h"
+#include "packedmove.h"
 
 using namespace std;
 
@@ -70,22 +72,45 @@ public:
 
 	// kibitzLength = 1 means kibitz list is of length one, and contains
 	// only the best move, and allPossiblePlays() is invalid.
-	// kibitzLength <= 1 interpreted as kibitz length of 1
+	// kibitzLength <= 1 interpreted as kibitz length of 1.
+	// Only the best kibitzLength plays are ever kept, so
+	// allPossiblePlays() holds no more than that many.
 	void kibitz(int kibitzLength = 10, int flags = AnagramRearrange);
 
 	const MoveList &kibitzList();
+
+	// Despite the name, not every possible play: the plays the last
+	// kibitz kept, which are the best kibitzLength at most (fewer
+	// with an equity window), best first. Kibitz with a length of
+	// INT_MAX to have them all.
 	const MoveList &allPossiblePlays();
 
+	// When kibitzing more than one play, drop plays whose equity is
+	// more than equityWindow below the best play as they are found.
+	// Negative (the default) keeps plays regardless of equity.
+	void setEquityWindow(double equityWindow);
+	double equityWindow() const;
+
 	// set generator to generate on this position
 	// (using current player's rack)
 	void setPosition(const GamePosition &position);
 	const GamePosition &position() const;
 
+	// the position generated on, for searches that play moves
+	// on it and take them back between generations rather than
+	// setting a new position each time
+	GamePosition &underlyingPosition();
+
 	// place a move on the board; if regenerateCrosses is false,
 	// you'll need to call allCrosses if you want to make more plays
 	// on the board
 	void makeMove(const Move &move, bool regenerateCrosses);
 
+	// same, but works directly on the given board so callers
+	// need not copy a position into a Generator. If undo is
+	// nonzero, what changes is saved in it for Board::unmakeMove.
+	static void makeMove(Board &board, const Move &move, bool regenerateCrosses, BoardUndo *undo = 0);
+
 	enum AnagramFlags { AnagramRearrange	= 0x0000, 
 			    NoRequireAllLetters	= 0x0001, 
 			    AddAnyLetters	= 0x0002, 
@@ -97,6 +122,7 @@ public:
 	void storeWordInfo(WordWithInfo *wordWithInfo);
 	void storeExtensions(WordWithInfo *wordWithInfo);
 	void allCrosses();
+	static void allCrosses(Board &board);
 
 private:
 	// only keep track of best move
@@ -122,10 +148,19 @@ private:
 	void setupCounts(const LetterString &letters);
 
 	// returned letter is a fancy letter
-	void readFromDawg(int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability) const;
+	static void readFromDawg(int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability);
+
+	static bool checksuffix(int i, const LetterString &suffix); 
+
+	// letters that make a word of pre, the letter and suf, looked up
+	// in the lexicon's CrossCache before being worked out
+	static LetterBitset fitbetween(const LetterString &pre, const LetterString &suf);
+	static LetterBitset dawgFitbetween(const LetterString &pre, const LetterString &suf);
+
+	// recompute the cross set of one empty square
+	static void updateVCross(Board &board, int row, int col);
+	static void updateHCross(Board &board, int row, int col);
 
-	bool checksuffix(int i, const LetterString &suffix); 
-	LetterBitset fitbetween(const LetterString &pre, const LetterString &suf);
 	void extendright(const LetterString &partial, int i,  
 			int row, int col, int edge, int righttiles, 
 			bool horizontal);
@@ -134,12 +169,21 @@ private:
 	void spit(int i, const LetterString &prefix, int flags);
 	void wordspit(int i, const LetterString &prefix, int flags);
 
-	LetterBitset gaddagFitbetween(const LetterString &pre, const LetterString &suf);
+	static LetterBitset gaddagFitbetween(const LetterString &pre, const LetterString &suf);
 	void gaddagAnagram(const GaddagNode *node, const LetterString &prefix, int flags);
 	void gordongen(int pos, const LetterString &word, const GaddagNode *node);
 	void gordongoon(int pos, char L, LetterString word, const GaddagNode *node);
 
-	void filterOutDuplicatePlays();
+	// updates best and, when recording all plays, keeps move in the
+	// heap of the kibitzLength best plays
+	void recordMove(const Move &move);
+
+	// scores the plays in m_pendingMoves as one batch, then records
+	// them in the order they were found
+	void recordPendingMoves();
+
+	// true if this one-tile play was already found in the other direction
+	bool isDuplicateOneTilePlay(const Move &move);
 
 	// debug stuff
 	UVString counts2string();
@@ -147,8 +191,55 @@ private:
 
 	Move best;
 
-	// keeps *all* moves
-	MoveList m_moveList;
+	// a play found, packed, with its equity
+	struct RecordedMove
+	{
+		RecordedMove(const Move &_move, int _whole) : equity(_move.equity), move(_move), whole(_whole) { }
+		double equity;
+		PackedMove move;
+
+		// index of the move in m_wholeMoves if it can't be packed,
+		// else -1
+		int whole;
+	};
+
+	// records move, which need not be packable, in m_moveList
+	RecordedMove record(const Move &move);
+
+	// orders plays by equity, best first, and so a heap of them
+	// with the worst at the front
+	static bool betterRecordedMove(const RecordedMove &move1, const RecordedMove &move2);
+
+	// the move recorded, unpacked against the board
+	Move unpack(const RecordedMove &recorded);
+
+	// keeps the best m_kibitzLength moves, as a heap with the
+	// worst at the front
+	vector<RecordedMove> m_moveList;
+
+	// moves in m_moveList too big to pack, such as ones laying more
+	// tiles than a packed move holds on racks made bigger than usual
+	MoveList m_wholeMoves;
+
+	// slots in m_wholeMoves of moves since dropped from m_moveList,
+	// reused so that it never outgrows m_moveList
+	vector<int> m_freeWholeMoves;
+
+	// m_moveList unpacked, when asked for
+	MoveList m_allPossiblePlays;
+	bool m_allPossiblePlaysUnpacked;
+
+	// plays found but not yet scored, all along one row or column
+	MoveList m_pendingMoves;
+	int m_kibitzLength;
+	double m_equityWindow;
+	double m_bestRecordedEquity;
+
+	// one-tile plays found so far, by letter, column and row
+	bitset<(QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE) * QUACKLE_MAXIMUM_BOARD_SIZE * QUACKLE_MAXIMUM_BOARD_SIZE> m_oneTilePlays;
+
+	// the bits set in m_oneTilePlays
+	vector<int> m_oneTilePlayKeys;
 
 	// sorts and prunes into kibitzed list
 	MoveList m_kibitzList;
@@ -156,6 +247,10 @@ private:
 	GamePosition m_position;
 
 	char m_counts[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE];
+
+	// GaddagNode::letterBit of each nonblank letter left in m_counts,
+	// kept up to date by gordongen
+	uint64_t m_rackMask;
 	int m_laid;
 	int m_leftlimit;
 
@@ -178,6 +273,11 @@ inline const GamePosition &Generator::position() const
 	return m_position;
 }
 
+inline GamePosition &Generator::underlyingPosition()
+{
+	return m_position;
+}
+
 inline Board &Generator::board()
 {
 	return m_position.underlyingBoardReference();
@@ -193,14 +293,19 @@ inline void Generator::setrecordall(bool b)
 	m_recordall = b;
 }
 
-inline const MoveList &Generator::kibitzList()
+inline void Generator::setEquityWindow(double equityWindow)
 {
-	return m_kibitzList;
+	m_equityWindow = equityWindow;
+}
+
+inline double Generator::equityWindow() const
+{
+	return m_equityWindow;
 }
 
-inline const MoveList &Generator::allPossiblePlays()
+inline const MoveList &Generator::kibitzList()
 {
-	return m_moveList;
+	return m_kibitzList;
 }
 
 }
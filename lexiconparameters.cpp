@@ -29,24 +29,16 @@ using namespace Quackle;
 class Quackle::V0LexiconInterpreter : public LexiconInterpreter
 {
 
-	virtual void loadDawg(ifstream &file, LexiconParameters &lexparams)
+	// v0 files have no header
+	virtual void loadDawgHeader(ifstream &file, LexiconParameters &)
 	{
-		int i = 0;
-		while (!file.eof())
-		{
-			file.read((char*)(lexparams.m_dawg) + i, 7);
-			i += 7;
-		}
+		file.seekg(0, ios_base::beg);
 	}
 
-	virtual void loadGaddag(ifstream &file, LexiconParameters &lexparams)
+	virtual bool loadGaddagHeader(ifstream &file, LexiconParameters &)
 	{
-		int i = 0;
-		while (!file.eof())
-		{
-			file.read((char*)(lexparams.m_gaddag) + i, 4);
-			i += 4;
-		}
+		file.seekg(0, ios_base::beg);
+		return true;
 	}
 
 	virtual void dawgAt(const unsigned char *dawg, int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability) const
@@ -68,10 +60,10 @@ class Quackle::V0LexiconInterpreter : public LexiconInterpreter
 class Quackle::V1LexiconInterpreter : public LexiconInterpreter
 {
 
-	virtual void loadDawg(ifstream &file, LexiconParameters &lexparams)
+	virtual void loadDawgHeader(ifstream &file, LexiconParameters &lexparams)
 	{
-		int i = 0;
 		unsigned char bytes[3];
+		file.seekg(0, ios_base::beg);
 		file.get(); // skip past version byte
 		file.read(lexparams.m_hash, sizeof(lexparams.m_hash));
 		file.read((char*)bytes, 3);
@@ -82,16 +74,12 @@ class Quackle::V1LexiconInterpreter : public LexiconInterpreter
 			file >> lexparams.m_utf8Alphabet[i];
 			file.get(); // separator space
 		}
-		while (!file.eof())
-		{
-			file.read((char*)(lexparams.m_dawg) + i, 7);
-			i += 7;
-		}
 	}
 
-	virtual void loadGaddag(ifstream &file, LexiconParameters &lexparams)
+	virtual bool loadGaddagHeader(ifstream &file, LexiconParameters &lexparams)
 	{
 		char hash[16];
+		file.seekg(0, ios_base::beg);
 		file.get(); // skip past version byte
 		file.read(hash, sizeof(hash));
 		if (memcmp(hash, lexparams.m_hash, sizeof(hash)))
@@ -100,19 +88,11 @@ class Quackle::V1LexiconInterpreter : public LexiconInterpreter
 			for (size_t i = 0; i < sizeof(lexparams.m_hash); i++)
 			{
 				if (lexparams.m_hash[0] != 0)
-				{
-					lexparams.unloadGaddag(); // don't use a mismatched gaddag
-					return;
-				}
+					return false; // don't use a mismatched gaddag
 			}
 		}
 
-		size_t i = 0;
-		while (!file.eof())
-		{
-			file.read((char*)(lexparams.m_gaddag) + i, 4);
-			i += 4;
-		}
+		return true;
 	}
 
 	virtual void dawgAt(const unsigned char *dawg, int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability) const
@@ -131,8 +111,65 @@ class Quackle::V1LexiconInterpreter : public LexiconInterpreter
 	virtual int versionNumber() const { return 1; }
 };
 
+// v2 has the v1 headers but 32-bit pointers, for lexica whose dawg or
+// gaddag has more nodes than 24 bits can address
+class Quackle::V2LexiconInterpreter : public V1LexiconInterpreter
+{
+
+	virtual void dawgAt(const unsigned char *dawg, int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability) const
+	{
+		dawg += (size_t)index * 8;
+		p = ((unsigned int)dawg[0] << 24) + (dawg[1] << 16) + (dawg[2] << 8) + (dawg[3]);
+		letter = dawg[4];
+		
+		lastchild = ((letter & 64) != 0);
+		british = !(letter & 128);
+		letter = (letter & 63) + QUACKLE_FIRST_LETTER;
+
+		playability = (dawg[5] << 16) + (dawg[6] << 8) + (dawg[7]);
+		t = (playability != 0);
+	}
+
+	virtual size_t gaddagNodeSize() const { return 5; }
+	virtual void gaddagAt(const unsigned char *gaddag, size_t index, uint32_t &p, unsigned char &info) const
+	{
+		gaddag += index * 5;
+		p = ((uint32_t)gaddag[0] << 24) + (gaddag[1] << 16) + (gaddag[2] << 8) + gaddag[3];
+		info = gaddag[4];
+	}
+
+	virtual int versionNumber() const { return 2; }
+};
+
+// v3 is v2 with gaddag nodes stored as GaddagNode holds them, child
+// mask and all, little-endian; dawgs are never v3
+class Quackle::V3LexiconInterpreter : public V2LexiconInterpreter
+{
+
+	virtual size_t gaddagNodeSize() const { return 12; }
+	virtual void gaddagAt(const unsigned char *gaddag, size_t index, uint32_t &p, unsigned char &info) const
+	{
+		gaddag += index * 12;
+		p = gaddag[0] + (gaddag[1] << 8) + (gaddag[2] << 16) + ((uint32_t)gaddag[3] << 24);
+		info = gaddag[11];
+	}
+
+	virtual bool hasExpandedGaddagNodes() const { return true; }
+	virtual int versionNumber() const { return 3; }
+};
+
+static_assert(sizeof(GaddagNode) == 12, "v3 gaddag files hold GaddagNodes as they are");
+
+static bool isLittleEndian()
+{
+	const uint16_t one = 1;
+	unsigned char firstByte;
+	memcpy(&firstByte, &one, 1);
+	return firstByte == 1;
+}
+
 LexiconParameters::LexiconParameters()
-	: m_dawg(NULL), m_gaddag(NULL), m_interpreter(NULL)
+	: m_dawg(NULL), m_gaddag(NULL), m_gaddagBytes(NULL), m_useMemoryMapping(true), m_interpreter(NULL)
 {
 	memset(m_hash, 0, sizeof(m_hash));
 }
@@ -150,16 +187,48 @@ void LexiconParameters::unloadAll()
 
 void LexiconParameters::unloadDawg()
 {
-	delete[] m_dawg;
-	m_dawg = NULL;
+	unloadNodes(m_dawg, m_dawgFile);
 	delete m_interpreter;
 	m_interpreter = NULL;
+	m_crossCache.clear();
 }
 
 void LexiconParameters::unloadGaddag()
 {
-	delete[] m_gaddag;
+	unloadNodes(m_gaddagBytes, m_gaddagFile);
+	vector<GaddagNode>().swap(m_expandedGaddag);
 	m_gaddag = NULL;
+	m_crossCache.clear();
+}
+
+const unsigned char *LexiconParameters::loadNodes(ifstream &file, const string &filename, MappedFile &mappedFile)
+{
+	const streamoff offset = file.tellg();
+
+	if (m_useMemoryMapping && mappedFile.open(filename))
+	{
+		if ((size_t)offset <= mappedFile.size())
+			return mappedFile.data() + offset;
+		mappedFile.close();
+	}
+
+	file.seekg(0, ios_base::end);
+	const streamoff size = file.tellg() - offset;
+	file.seekg(offset, ios_base::beg);
+
+	unsigned char *nodes = new unsigned char[size];
+	file.read((char *)nodes, size);
+	return nodes;
+}
+
+void LexiconParameters::unloadNodes(const unsigned char *&nodes, MappedFile &mappedFile)
+{
+	if (mappedFile.isOpen())
+		mappedFile.close();
+	else
+		delete[] nodes;
+
+	nodes = NULL;
 }
 
 void LexiconParameters::loadDawg(const string &filename)
@@ -181,11 +250,8 @@ void LexiconParameters::loadDawg(const string &filename)
 		return;
 	}
 
-	file.seekg(0, ios_base::end);
-	m_dawg = new unsigned char[file.tellg()];
-	file.seekg(0, ios_base::beg);
-
-	m_interpreter->loadDawg(file, *this);
+	m_interpreter->loadDawgHeader(file, *this);
+	m_dawg = loadNodes(file, filename, m_dawgFile);
 }
 
 void LexiconParameters::loadGaddag(const string &filename)
@@ -200,22 +266,58 @@ void LexiconParameters::loadGaddag(const string &filename)
 		return;
 	}
 
+	// v0 gaddags have no hash to check against a later dawg; past
+	// that, versions differ only in how wide pointers are
 	char versionByte = file.get();
-	if (versionByte < m_interpreter->versionNumber())
+	if (versionByte == 0 && m_interpreter->versionNumber() > 0)
 		return;
-	file.seekg(0, ios_base::end);
-	m_gaddag = new unsigned char[file.tellg()];
-	file.seekg(0, ios_base::beg);
 
 	// must create a local interpreter because dawg/gaddag versions might not match
 	LexiconInterpreter* interpreter = createInterpreter(versionByte);
 	if (interpreter != NULL)
 	{
-		interpreter->loadGaddag(file, *this);
+		if (interpreter->loadGaddagHeader(file, *this))
+		{
+			const streamoff offset = file.tellg();
+			file.seekg(0, ios_base::end);
+			const size_t nodeBytes = file.tellg() - offset;
+			const size_t nodeCount = nodeBytes / interpreter->gaddagNodeSize();
+			file.seekg(offset, ios_base::beg);
+
+			if (interpreter->hasExpandedGaddagNodes() && isLittleEndian())
+			{
+				// nodes are used just as they are read, so a truncated
+				// or corrupt file must not get that far
+				m_gaddagBytes = loadNodes(file, filename, m_gaddagFile);
+				const GaddagNode *nodes = reinterpret_cast<const GaddagNode *>(m_gaddagBytes);
+				if (nodeCount > 0 && nodeBytes % interpreter->gaddagNodeSize() == 0 && GaddagNode::checkChildren(nodes, nodeCount))
+					m_gaddag = nodes;
+			}
+			else
+			{
+				MappedFile mappedFile;
+				const unsigned char *packed = loadNodes(file, filename, mappedFile);
+				m_expandedGaddag.resize(nodeCount);
+				for (size_t i = 0; i < nodeCount; ++i)
+				{
+					uint32_t p;
+					unsigned char info;
+					interpreter->gaddagAt(packed, i, p, info);
+					m_expandedGaddag[i].set(p, info);
+				}
+				if (nodeCount > 0 && GaddagNode::linkChildren(&m_expandedGaddag[0], nodeCount))
+					m_gaddag = &m_expandedGaddag[0];
+				unloadNodes(packed, mappedFile);
+			}
+
+			if (m_gaddag == NULL)
+			{
+				UVcout << "couldn't read gaddag " << filename.c_str() << endl;
+				unloadGaddag();
+			}
+		}
 		delete interpreter;
 	}
-	else
-		unloadGaddag();
 }
 
 string LexiconParameters::findDictionaryFile(const string &lexicon)
@@ -267,6 +369,10 @@ LexiconInterpreter* LexiconParameters::createInterpreter(char version) const
 			return new V0LexiconInterpreter();
 		case 1:
 			return new V1LexiconInterpreter();
+		case 2:
+			return new V2LexiconInterpreter();
+		case 3:
+			return new V3LexiconInterpreter();
 		default:
 			return NULL;
 	}
@@ -21,7 +21,9 @@
 
 #include <vector>
 
+#include "crosscache.h"
 #include "gaddag.h"
+#include "mappedfile.h"
 
 namespace Quackle
 {
@@ -31,20 +33,44 @@ class LexiconParameters;
 class LexiconInterpreter
 {
 public:
-	virtual void loadDawg(ifstream &file, LexiconParameters &lexparams) = 0;
-	virtual void loadGaddag(ifstream &file, LexiconParameters &lexparams) = 0;
+	// Read the header of a dawg or gaddag file, leaving file at the
+	// first node. loadGaddagHeader returns false if the gaddag does
+	// not go with the loaded dawg.
+	virtual void loadDawgHeader(ifstream &file, LexiconParameters &lexparams) = 0;
+	virtual bool loadGaddagHeader(ifstream &file, LexiconParameters &lexparams) = 0;
 	virtual void dawgAt(const unsigned char *dawg, int index, unsigned int &p, Letter &letter, bool &t, bool &lastchild, bool &british, int &playability) const = 0;
+
+	// Gaddag nodes are gaddagNodeSize() bytes on disk. gaddagAt reads
+	// the offset in nodes to a node's first child and the node's byte
+	// holding its letter and terminal and last-child flags; v0 and v1
+	// pack both into 4 bytes, v2 widens the offset to 32 bits. v3
+	// nodes are stored just as a GaddagNode is in memory, so on hosts
+	// of the same byte order they are used as they are.
+	virtual size_t gaddagNodeSize() const { return 4; }
+	virtual void gaddagAt(const unsigned char *gaddag, size_t index, uint32_t &p, unsigned char &info) const
+	{
+		gaddag += index * 4;
+		p = (gaddag[0] << 16) + (gaddag[1] << 8) + gaddag[2];
+		info = gaddag[3];
+	}
+
+	virtual bool hasExpandedGaddagNodes() const { return false; }
+
 	virtual int versionNumber() const = 0;
 	virtual ~LexiconInterpreter() {};
 };
 
 class V0LexiconInterpreter;
 class V1LexiconInterpreter;
+class V2LexiconInterpreter;
+class V3LexiconInterpreter;
 
 class LexiconParameters
 {
 	friend class Quackle::V0LexiconInterpreter;
 	friend class Quackle::V1LexiconInterpreter;
+	friend class Quackle::V2LexiconInterpreter;
+	friend class Quackle::V3LexiconInterpreter;
 
 public:
 	LexiconParameters();
@@ -66,6 +92,17 @@ public:
 	void unloadGaddag();
 	bool hasGaddag() const { return m_gaddag != NULL; };
 
+	// If true (the default), dawgs and v3 gaddags loaded from now on
+	// are mapped read-only into memory rather than copied onto the
+	// heap, so that processes using the same lexicon share one copy.
+	// Loading falls back to copying where mapping fails. Gaddags in
+	// older formats are expanded onto the heap with a child mask per
+	// node; see GaddagNode.
+	void setUseMemoryMapping(bool useMemoryMapping) { m_useMemoryMapping = useMemoryMapping; };
+	bool useMemoryMapping() const { return m_useMemoryMapping; };
+	bool isDawgMapped() const { return m_dawgFile.isOpen(); };
+	bool isGaddagMapped() const { return m_gaddagFile.isOpen(); };
+
 	// finds a file in the lexica data directory
 	static string findDictionaryFile(const string &lexicon);
 	static bool hasUserDictionaryFile(const string &lexicon);
@@ -78,21 +115,39 @@ public:
 	{
 		m_interpreter->dawgAt(m_dawg, index, p, letter, t, lastchild, british, playability);
 	}
-	const GaddagNode *gaddagRoot() const { return (GaddagNode *) &m_gaddag[0]; };
+	const GaddagNode *gaddagRoot() const { return m_gaddag; };
+
+	// cross sets of board fragments in this lexicon, emptied
+	// whenever the dawg or gaddag is unloaded
+	CrossCache *crossCache() { return &m_crossCache; };
 
 	string hashString(bool shortened) const;
 	string copyrightString() const;
 	const vector<string> &utf8Alphabet() const { return m_utf8Alphabet; };
 
 protected:
-	unsigned char *m_dawg;
-	unsigned char *m_gaddag;
+	const unsigned char *m_dawg;
+	MappedFile m_dawgFile;
+
+	// the nodes of a v3 gaddag as loaded, or those of an older one
+	// expanded into m_expandedGaddag
+	const GaddagNode *m_gaddag;
+	const unsigned char *m_gaddagBytes;
+	MappedFile m_gaddagFile;
+	vector<GaddagNode> m_expandedGaddag;
+	bool m_useMemoryMapping;
 	string m_lexiconName;
 	LexiconInterpreter *m_interpreter;
 	char m_hash[16];
 	vector<string> m_utf8Alphabet;
+	CrossCache m_crossCache;
 
 	LexiconInterpreter* createInterpreter(char version) const;
+
+	// Returns the nodes from the current position of file on, either
+	// in a mapping of filename or in a heap copy
+	const unsigned char *loadNodes(ifstream &file, const string &filename, MappedFile &mappedFile);
+	void unloadNodes(const unsigned char *&nodes, MappedFile &mappedFile);
 };
 
 }
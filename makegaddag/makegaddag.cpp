@@ -45,9 +45,11 @@ int main(int argc, char **argv)
 	QString alphabet;
 	QString inputFilename;
 	QString outputFilename;
+	bool mappable = false;
 	opts.addOption('f', "input", &inputFilename);
 	opts.addOption('o', "output", &outputFilename);
 	opts.addOption('a', "alphabet", &alphabet);
+	opts.addSwitch("mappable", &mappable);
 	if (!opts.parse())
 		return 1;
 
@@ -63,6 +65,7 @@ int main(int argc, char **argv)
 	QString alphabetFile = QString("../data/alphabets/%1.quackle_alphabet").arg(alphabet);
 	UVcout << "Using alphabet file: " << QuackleIO::Util::qstringToString(alphabetFile) << endl;
 	GaddagFactory factory(QuackleIO::Util::qstringToString(alphabetFile));
+	factory.setMappable(mappable);
 
 	QFile file(inputFilename);
 	if (!file.exists())
@@ -92,17 +95,20 @@ int main(int argc, char **argv)
 			UVcout << "not encodable without leftover: " << QuackleIO::Util::qstringToString(originalQString) << endl;
 	}
 	
-	UVcout << "Sorting " << factory.wordCount() << " words..." << endl;
-	factory.sortWords();
-
-	UVcout << "Generating nodes...";
+	UVcout << "Generating nodes for " << factory.wordCount() << " words...";
 	factory.generate();
 
 	UVcout << "Writing index...";
-	factory.writeIndex(outputFilename.toUtf8().constData());
+	const bool written = factory.writeIndex(outputFilename.toUtf8().constData());
 
 	UVcout << endl;
 
+	if (!written)
+	{
+		UVcout << "Couldn't write " << QuackleIO::Util::qstringToString(outputFilename) << "." << endl;
+		return 1;
+	}
+
 	UVcout << "Wrote " << factory.encodableWords() << " words over " << factory.nodeCount() << " nodes to " << QuackleIO::Util::qstringToString(outputFilename) << "." << endl;
 
 	UVcout << "Hash: " << QString(QByteArray(factory.hashBytes(), 16).toHex()).toStdString() << endl;
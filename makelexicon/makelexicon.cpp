@@ -0,0 +1,225 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <thread>
+
+#include <QtCore>
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+
+#include "quackleio/dawgfactory.h"
+#include "quackleio/froggetopt.h"
+#include "quackleio/gaddagfactory.h"
+#include "quackleio/util.h"
+
+using namespace std;
+
+// Builds a dawg and a gaddag of the same word list, reading it once.
+
+static bool readWords(const QString &filename, QStringList *words)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		UVcout << "Could not open " << QuackleIO::Util::qstringToString(filename) << endl;
+		return false;
+	}
+
+	QTextStream stream(&file);
+	stream.setCodec(QTextCodec::codecForName("UTF-8"));
+	while (!stream.atEnd())
+	{
+		QString word;
+		stream >> word;
+		if (!word.isEmpty())
+			words->append(word);
+	}
+
+	return true;
+}
+
+// peak resident memory of this process in kilobytes, or -1 if unknown
+static long peakMemory()
+{
+#ifdef Q_OS_WIN
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+#ifdef Q_OS_MAC
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static void reportMemory()
+{
+	const long peak = peakMemory();
+	if (peak >= 0)
+		UVcout << "Peak memory: " << peak / 1024 << " MB" << endl;
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication a(argc, argv);
+
+	GetOpt opts;
+	QString alphabet;
+	QString inputFilename;
+	QString smallerFilename;
+	QString playabilityFilename;
+	QString outputName;
+	bool mappable = false;
+	opts.addOption('f', "input", &inputFilename);
+	opts.addOption('s', "smaller", &smallerFilename);
+	opts.addOption('p', "playabilities", &playabilityFilename);
+	opts.addOption('o', "output", &outputName);
+	opts.addOption('a', "alphabet", &alphabet);
+	opts.addSwitch("mappable", &mappable);
+	if (!opts.parse())
+	{
+		UVcout << "usage: makelexicon [--input=dawginput.raw] [--smaller=smaller.raw] [--playabilities=playabilities.raw] [--output=output] [--alphabet=english] [--mappable]" << endl;
+		UVcout << "Writes <output>.dawg and <output>.gaddag. Words not in the smaller list are marked british; without one, none are." << endl;
+		UVcout << "With --mappable, the gaddag is written as v3, which loads without expanding but is three times the size and needs a current build." << endl;
+		return 1;
+	}
+
+	if (alphabet.isNull())
+		alphabet = "english";
+
+	if (inputFilename.isNull())
+		inputFilename = "dawginput.raw";
+
+	if (outputName.isNull())
+		outputName = "output";
+
+	const string dawgFilename = QuackleIO::Util::qstringToStdString(outputName + ".dawg");
+	const string gaddagFilename = QuackleIO::Util::qstringToStdString(outputName + ".gaddag");
+
+	QString alphabetFile = QString("../data/alphabets/%1.quackle_alphabet").arg(alphabet);
+	UVcout << "Using alphabet file: " << QuackleIO::Util::qstringToString(alphabetFile) << endl;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QSet<QString> smallerWords;
+	if (!smallerFilename.isNull())
+	{
+		QStringList words;
+		if (!readWords(smallerFilename, &words))
+			return 1;
+		smallerWords = words.toSet();
+	}
+
+	QHash<QString, int> playabilities;
+	if (!playabilityFilename.isNull())
+	{
+		QFile playability(playabilityFilename);
+		if (!playability.open(QIODevice::ReadOnly | QIODevice::Text))
+		{
+			UVcout << "Could not open " << QuackleIO::Util::qstringToString(playabilityFilename) << endl;
+			return 1;
+		}
+
+		QTextStream playabilityStream(&playability);
+		playabilityStream.setCodec(QTextCodec::codecForName("UTF-8"));
+		while (!playabilityStream.atEnd())
+		{
+			int pb;
+			QString word;
+			playabilityStream >> pb >> word;
+			if (!word.isEmpty())
+				playabilities[word] = pb;
+		}
+	}
+
+	DawgFactory dawgFactory(alphabetFile);
+	GaddagFactory gaddagFactory(QuackleIO::Util::qstringToString(alphabetFile));
+	gaddagFactory.setMappable(mappable);
+
+	// Words are streamed into both factories as they are read. Only
+	// words the dawg takes go in the gaddag, so that duplicates don't
+	// throw off the gaddag's hash.
+	QFile file(inputFilename);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		UVcout << "Could not open " << QuackleIO::Util::qstringToString(inputFilename) << endl;
+		return 1;
+	}
+
+	QTextStream stream(&file);
+	stream.setCodec(QTextCodec::codecForName("UTF-8"));
+	while (!stream.atEnd())
+	{
+		QString word;
+		stream >> word;
+		if (word.isEmpty())
+			continue;
+
+		const UVString uvWord = QuackleIO::Util::qstringToString(word);
+		const bool inSmaller = smallerFilename.isNull() || smallerWords.contains(word);
+		const int unencodable = dawgFactory.unencodableWords();
+
+		if (dawgFactory.pushWord(uvWord, inSmaller, playabilities.value(word)))
+			gaddagFactory.pushWord(uvWord);
+		else if (dawgFactory.unencodableWords() != unencodable)
+			UVcout << "not encodable without leftover: " << uvWord << endl;
+	}
+	file.close();
+
+	UVcout << "Read " << dawgFactory.encodableWords() << " words (" << dawgFactory.unencodableWords() << " unencodable, " << dawgFactory.duplicateWords() << " duplicates) in " << timer.elapsed() << " ms" << endl;
+	reportMemory();
+
+	// The dawg and the gaddag share nothing, so they are built at once.
+	qint64 dawgTime = 0;
+	std::thread dawgThread([&]() {
+		QElapsedTimer dawgTimer;
+		dawgTimer.start();
+		dawgFactory.generate();
+		dawgFactory.writeIndex(dawgFilename);
+		dawgTime = dawgTimer.elapsed();
+	});
+
+	QElapsedTimer gaddagTimer;
+	gaddagTimer.start();
+	gaddagFactory.generate();
+	const bool gaddagWritten = gaddagFactory.writeIndex(gaddagFilename);
+	const qint64 gaddagTime = gaddagTimer.elapsed();
+
+	dawgThread.join();
+
+	UVcout << "Wrote " << dawgFactory.nodeCount() << " dawg nodes to " << dawgFilename << " in " << dawgTime << " ms" << endl;
+	if (!gaddagWritten)
+	{
+		UVcout << "Couldn't write " << gaddagFilename << "." << endl;
+		return 1;
+	}
+	UVcout << "Wrote " << gaddagFactory.nodeCount() << " gaddag nodes to " << gaddagFilename << " in " << gaddagTime << " ms" << endl;
+
+	UVcout << "Hash: " << QString(QByteArray(dawgFactory.hashBytes(), 16).toHex()).toStdString() << endl;
+	UVcout << "Total time: " << timer.elapsed() << " ms" << endl;
+	reportMemory();
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUACKLE_MAPPEDFILE_H
+#define QUACKLE_MAPPEDFILE_H
+
+#include <string>
+
+using namespace std;
+
+namespace Quackle
+{
+
+// A whole file mapped read-only into memory. Pages are shared with
+// every other process that maps the same file.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// unmaps any previous file; returns false if filename
+	// can't be mapped on this platform or at all
+	bool open(const string &filename);
+	void close();
+
+	bool isOpen() const;
+	const unsigned char *data() const;
+	size_t size() const;
+
+private:
+	// not copyable
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+
+	const unsigned char *m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	void *m_fileHandle;
+	void *m_mappingHandle;
+#endif
+};
+
+inline bool MappedFile::isOpen() const
+{
+	return m_data != 0;
+}
+
+inline const unsigned char *MappedFile::data() const
+{
+	return m_data;
+}
+
+inline size_t MappedFile::size() const
+{
+	return m_size;
+}
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "board.h"
+#include "packedmove.h"
+
+using namespace Quackle;
+
+PackedMove::PackedMove()
+	: m_startrow(0), m_startcol(0), m_flags(Move::Nonmove), m_length(0), m_score(0)
+{
+	memset(m_tiles, QUACKLE_NULL_MARK, sizeof(m_tiles));
+}
+
+PackedMove::PackedMove(const Move &move)
+	: m_startrow(move.startrow), m_startcol(move.startcol), m_flags(move.action), m_length(move.tiles().length()), m_score(move.score)
+{
+	if (move.horizontal)
+		m_flags |= Horizontal;
+	if (move.isBingo)
+		m_flags |= Bingo;
+
+	memset(m_tiles, QUACKLE_NULL_MARK, sizeof(m_tiles));
+
+	int laid = 0;
+	const LetterString::const_iterator end(move.tiles().end());
+	for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it)
+	{
+		if (move.action == Move::Place && Move::isAlreadyOnBoard(*it))
+			continue;
+
+		if (laid == QUACKLE_PACKED_MOVE_MAXIMUM_TILES)
+			break;
+
+		m_tiles[laid++] = *it;
+	}
+}
+
+bool PackedMove::canPack(const Move &move)
+{
+	if (move.isChallengedPhoney() || move.scoreAddition() != 0)
+		return false;
+
+	int laid = 0;
+	const LetterString::const_iterator end(move.tiles().end());
+	for (LetterString::const_iterator it = move.tiles().begin(); it != end; ++it)
+		if (move.action != Move::Place || !Move::isAlreadyOnBoard(*it))
+			++laid;
+
+	return laid <= QUACKLE_PACKED_MOVE_MAXIMUM_TILES;
+}
+
+Move PackedMove::unpack(const Board &board) const
+{
+	Move ret;
+	ret.action = action();
+	ret.horizontal = horizontal();
+	ret.startrow = m_startrow;
+	ret.startcol = m_startcol;
+	ret.score = m_score;
+	ret.isBingo = isBingo();
+
+	LetterString tiles;
+	int laid = 0;
+	int row = m_startrow;
+	int col = m_startcol;
+	for (int i = 0; i < m_length; ++i)
+	{
+		if (ret.action == Move::Place && board.isOccupied(row, col))
+			tiles += QUACKLE_PLAYED_THRU_MARK;
+		else
+			tiles += m_tiles[laid++];
+
+		if (ret.horizontal)
+			++col;
+		else
+			++row;
+	}
+
+	ret.setTiles(tiles);
+	return ret;
+}
+
+bool PackedMove::wordPosComparator(const PackedMove &move1, const PackedMove &move2)
+{
+	if (move1.m_startrow != move2.m_startrow)
+		return move1.m_startrow < move2.m_startrow;
+
+	if (move1.m_startcol != move2.m_startcol)
+		return move1.m_startcol < move2.m_startcol;
+
+	if (move1.horizontal() != move2.horizontal())
+		return move1.horizontal() < move2.horizontal();
+
+	if (move1.m_score != move2.m_score)
+		return move1.m_score < move2.m_score;
+
+	// Moves from the same square on one board play through the same
+	// squares for as long as both go on, so their laid tiles compare
+	// as their tiles would.
+	const int compared = memcmp(move1.m_tiles, move2.m_tiles, sizeof(move1.m_tiles));
+	if (compared != 0)
+		return compared < 0;
+
+	return move1.m_length < move2.m_length;
+}
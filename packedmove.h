@@ -0,0 +1,111 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUACKLE_PACKEDMOVE_H
+#define QUACKLE_PACKEDMOVE_H
+
+#include "move.h"
+
+#define QUACKLE_PACKED_MOVE_MAXIMUM_TILES 10
+
+namespace Quackle
+{
+
+class Board;
+
+// A move packed into 16 bytes, for keeping large numbers of them
+// while generating. Only the tiles a play lays down are kept, so
+// unpacking a place move takes the board it was found on to fill
+// in the tiles it plays through. Equity is not kept; whoever ranks
+// packed moves keeps it alongside them.
+// A move can be packed if it has no more than
+// QUACKLE_PACKED_MOVE_MAXIMUM_TILES tiles besides those played
+// through, is not a challenged phoney, and has no score addition.
+// Packing any other move keeps only its first tiles, so it still
+// sorts but doesn't unpack to itself; keep it whole alongside.
+class PackedMove
+{
+public:
+	PackedMove();
+	explicit PackedMove(const Move &move);
+
+	static bool canPack(const Move &move);
+
+	// the move as it was packed, but with zero equity
+	Move unpack(const Board &board) const;
+
+	Move::Action action() const;
+	bool horizontal() const;
+	int startrow() const;
+	int startcol() const;
+	int score() const;
+	bool isBingo() const;
+
+	// orders packed moves found on one board the same way
+	// MoveList::wordPosComparator orders them unpacked
+	static bool wordPosComparator(const PackedMove &move1, const PackedMove &move2);
+
+private:
+	enum Flags { Horizontal = 0x10, Bingo = 0x20, ActionMask = 0x0f };
+
+	unsigned char m_startrow;
+	unsigned char m_startcol;
+	unsigned char m_flags;
+
+	// number of tiles in the move, including those played through
+	unsigned char m_length;
+
+	short m_score;
+
+	// tiles laid down, padded with QUACKLE_NULL_MARK
+	Letter m_tiles[QUACKLE_PACKED_MOVE_MAXIMUM_TILES];
+};
+
+inline Move::Action PackedMove::action() const
+{
+	return static_cast<Move::Action>(m_flags & ActionMask);
+}
+
+inline bool PackedMove::horizontal() const
+{
+	return m_flags & Horizontal;
+}
+
+inline int PackedMove::startrow() const
+{
+	return m_startrow;
+}
+
+inline int PackedMove::startcol() const
+{
+	return m_startcol;
+}
+
+inline int PackedMove::score() const
+{
+	return m_score;
+}
+
+inline bool PackedMove::isBingo() const
+{
+	return m_flags & Bingo;
+}
+
+}
+
+#endif
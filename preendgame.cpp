@@ -16,15 +16,20 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <math.h>
+#include <thread>
 #include <time.h>
 
 #include "bogowinplayer.h"
 #include "clock.h"
+#include "datamanager.h"
 #include "enumerator.h"
 #include "preendgame.h"
 #include "resolvent.h"
+#include "resultcache.h"
 
 using namespace Quackle;
 
@@ -106,6 +111,7 @@ Move Preendgame::move()
 
 MoveList Preendgame::moves(int nmoves)
 {
+	DataManagerScope scope(dataManager());
 	MoveList ret;
 	if (currentPosition().bag().empty() || currentPosition().bag().size() > maximumTilesInBagToEngage())
 	{
@@ -130,6 +136,16 @@ MoveList Preendgame::moves(int nmoves)
 	
 	signalFractionDone(0);
 
+	// Only the top level spreads out over threads and reports on the
+	// result cache. Nested preendgames run inside one of its work
+	// items.
+	const bool topLevel = currentPosition().nestedness() == 0;
+	const int threadsToUse = topLevel? threadCount() : 1;
+
+	ResultCache *cache = QUACKLE_RESULT_CACHE;
+	const long lookupsBefore = cache->lookups();
+	const long hitsBefore = cache->hits();
+
 	MoveList moves;
 	getInitialMoves(&moves);
 	if (m_debugPreendgame)
@@ -145,37 +161,131 @@ MoveList Preendgame::moves(int nmoves)
 		// (*moveIt).equity = 0;
 	}
 
-	GamePosition tempPosition;
-	Resolvent resolvent;
+	// Each pair of a move and a rack is a work item. Threads take
+	// items in order and give each a random stream of its own, and
+	// the results are added up in item order afterwards, so which
+	// thread ran an item has no effect on the outcome. For the same
+	// reason, results the items store in the cache are held back
+	// until all are done, so items only find those of earlier calls.
+	const int rackCount = racks.size();
+	const int itemCount = moves.size() * rackCount;
+	const uint64_t seed = DataManager::self()->randomNumber();
+
+	vector<Move> responses(itemCount);
+	vector<char> finished(itemCount, false);
+	vector<ResultCache::Batch> batches(topLevel? itemCount : 0);
+
+	atomic<int> nextItem(0);
+	atomic<int> finishedItems(0);
+	atomic<int> lastMove(static_cast<int>(moves.size()) - 1);
+	atomic<bool> outOfTime(false);
+	atomic<bool> aborted(false);
+
+	DataManager *dataManager = DataManager::self();
+	const GamePosition &position = currentPosition();
+
+	// Only the calling thread talks to the dispatch.
+	auto work = [&](bool ownsDispatch)
+	{
+		DataManagerScope scope(dataManager);
+		RandomStreamScope streamScope;
+
+		// Making the thread's players deals them a game, which draws
+		// on the shared generator unless the thread has a stream.
+		DataManager::self()->setThreadRandomGenerator(RandomGenerator(seed - 1));
+
+		GamePosition tempPosition;
+		Resolvent resolvent;
+
+		while (!aborted)
+		{
+			if (ownsDispatch)
+			{
+				if (shouldAbort())
+				{
+					aborted = true;
+					break;
+				}
+
+				signalFractionDone(fractionAllottedToInitialBogo + (1 - fractionAllottedToInitialBogo) * (max(static_cast<double>(finishedItems) / static_cast<double>(itemCount), static_cast<double>(stopwatch.elapsed()) / static_cast<double>(timeLimit))));
+			}
+
+			// once time is up, moves already begun are seen through
+			// but no others are started
+			if (stopwatch.exceeded(timeLimit) && !outOfTime.exchange(true))
+				lastMove = (nextItem - 1) / rackCount;
+
+			const int item = nextItem++;
+			if (item >= itemCount || item / rackCount > lastMove)
+				break;
+
+			const Move &move = moves[item / rackCount];
+			const ProbableRack &rack = racks[item % rackCount];
+
+			DataManager::self()->setThreadRandomGenerator(RandomGenerator(seed + item));
+
+			tempPosition = position;
+
+			tempPosition.setOppRack(rack.rack);
+			tempPosition.setMoveMade(move);
+			tempPosition.incrementTurn(NULL);
+			tempPosition.makeMove(move);
+			//tempPosition.incrementNestedness();
+
+			if (topLevel)
+				ResultCache::setThreadBatch(&batches[item]);
+
+			resolvent.setPosition(tempPosition);
+			responses[item] = resolvent.move();
+
+			finished[item] = true;
+			++finishedItems;
+		}
+
+		if (topLevel)
+			ResultCache::setThreadBatch(0);
+	};
 
+	vector<thread> helpers;
+	for (int i = 1; i < threadsToUse && i < itemCount; ++i)
+		helpers.push_back(thread(work, false));
+
+	work(true);
+
+	for (auto &it : helpers)
+		it.join();
+
+	for (const auto &it : batches)
+		cache->store(it);
+
+	if (topLevel)
+	{
+		const long lookups = cache->lookups() - lookupsBefore;
+		const long hits = cache->hits() - hitsBefore;
+		UVcout << "Preendgame result cache: " << hits << " hits in " << lookups << " lookups (" << (lookups > 0? 100 * hits / lookups : 0) << "%), " << cache->size() << " of " << cache->capacity() << " entries in use" << endl;
+	}
+
+	// A move counts once the responses to all its racks are in. After
+	// an abort, that is the unbroken run of moves a one-thread run
+	// would have finished; the rest keep a win of zero.
 	int j = 0;
 	for (MoveList::iterator moveIt = moves.begin(); moveIt != moves.end(); ++moveIt, ++j)
 	{
+		if (find(finished.begin() + j * rackCount, finished.begin() + (j + 1) * rackCount, false) != finished.begin() + (j + 1) * rackCount)
+			break;
+
 		(*moveIt).win = 1;
 		(*moveIt).possibleWin = 1;
 
 		int i = 0;
 		for (ProbableRackList::iterator it = racks.begin(); it != racks.end(); ++it, ++i)
 		{
+			const Move &resolventMove = responses[j * rackCount + i];
+
 			if (m_debugPreendgame)
 			{
 				UVcout << "\n" << currentPosition().nestednessIndentation() << "Turn " << currentPosition().turnNumber() << ", Rack " << i + 1 << " of " << racks.size() << ", Move " << j + 1 << " of " << moves.size() << ": " << *moveIt << "." << endl;
 				UVcout << currentPosition().nestednessIndentation() << currentPosition().currentPlayer().name() << " on turn with " << currentPosition().currentPlayer().rack() << " vs. oppo " << currentPosition().nextPlayer()->name() << " with " << (*it).rack << " prob " << (*it).probability << " poss " << (*it).possibility << endl;
-			}
-
-			tempPosition = currentPosition();
-
-			tempPosition.setOppRack((*it).rack);
-			tempPosition.setMoveMade(*moveIt);
-			tempPosition.incrementTurn(NULL);
-			tempPosition.makeMove(*moveIt);
-			//tempPosition.incrementNestedness();
-			
-			resolvent.setPosition(tempPosition);
-			Move resolventMove = resolvent.move();
-
-			if (m_debugPreendgame)
-			{
 				UVcout << currentPosition().nestednessIndentation() << "In response, resolvent makes move " << resolventMove << endl;
 			}
 
@@ -192,24 +302,14 @@ MoveList Preendgame::moves(int nmoves)
 			// This optimization leads to incorrect results.
 			//if (currentPosition().nestedness() > 0 && resolventMove.win == 0)
 			//	break;
-			
-			signalFractionDone(fractionAllottedToInitialBogo + (1 - fractionAllottedToInitialBogo) * (max(static_cast<double>(j * racks.size() + i) / static_cast<double>(racks.size() * moves.size()), static_cast<double>(stopwatch.elapsed()) / static_cast<double>(timeLimit))));
 		}
-
-		if (stopwatch.exceeded(timeLimit))
-			break;
-
-		if (shouldAbort())
-			goto sort_and_return;
 	}
 
-	if (m_debugPreendgame)
+	if (m_debugPreendgame && !aborted)
 	{
 		UVcout << currentPosition().nestednessIndentation() << "Turn " << currentPosition().turnNumber() << ": " << currentPosition().currentPlayer().name() << " on turn with " << currentPosition().currentPlayer().rack() << " has top 10 plays: " << endl;
 	}
 
-	sort_and_return:
-
 	MoveList::sort(moves, MoveList::Win);
 
 	int i = 1;
@@ -57,6 +57,9 @@ using namespace std;
 
 const int kExtraPlaysToKibitz = 15;
 
+// milliseconds between updates of views of a running simulation
+const int kSimulationRefreshInterval = 250;
+
 TopLevel::TopLevel(QWidget *parent)
 	: QMainWindow(parent), m_listerDialog(0), m_letterbox(0), m_simViewer(0), m_plies(2), m_logania(0), m_modified(false)
 {
@@ -75,6 +78,8 @@ TopLevel::TopLevel(QWidget *parent)
 	
 	m_game = new Quackle::Game;
 	m_simulator = new Quackle::Simulator;
+	m_simulator->setThreadCount(QThread::idealThreadCount());
+	m_simThread = new SimThread(m_simulator, this);
 
 	createMenu();
 	createWidgets();
@@ -90,6 +95,7 @@ TopLevel::TopLevel(QWidget *parent)
 TopLevel::~TopLevel()
 {
 	QuackleIO::Queenie::cleanUp();
+	delete m_simThread;
 	delete m_game;
 	delete m_simulator;
 	delete m_quackerSettings;
@@ -143,7 +149,8 @@ void TopLevel::finishInitialization()
 	m_timer = new QTimer(this);
 	connect(m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
 	m_simulationTimer = new QTimer(this);
-	connect(m_simulationTimer, SIGNAL(timeout()), this, SLOT(incrementSimulation()));
+	m_simulationTimer->setInterval(kSimulationRefreshInterval);
+	connect(m_simulationTimer, SIGNAL(timeout()), this, SLOT(refreshSimulation()));
 
 	// Birthday
 	m_birthdayTimer = new QTimer(this);
@@ -388,7 +395,7 @@ void TopLevel::setCandidateMove(const Quackle::Move &move)
 	// a check if we have simulation results -- but we don't want to send out
 	// a moves changed signal if we don't have results because
 	// we just sent out a position changed signal
-	if (m_simulator->hasSimulationResults())
+	if (m_simThread->snapshot().iterations > 0)
 		updateMoveViews();
 }
 
@@ -467,7 +474,10 @@ void TopLevel::setRack(const Quackle::Rack &rack)
 	}
 
 	m_game->currentPosition().setPlayerRack(m_game->currentPosition().currentPlayer().id(), rackToSet);
-	m_simulator->currentPosition().setCurrentPlayerRack(rackToSet);
+	{
+		SimThread::Locker locker(m_simThread);
+		m_simulator->currentPosition().setCurrentPlayerRack(rackToSet);
+	}
 	updatePositionViews();
 
 	statusMessage(tr("%1's rack set to %2.").arg(QuackleIO::Util::uvStringToQString(m_game->currentPosition().currentPlayer().name())).arg(QuackleIO::Util::letterStringToQString(rackToSet.tiles())));
@@ -608,10 +618,10 @@ void TopLevel::updatePositionViews()
 
 void TopLevel::updateMoveViews()
 {
-	if (m_simulator->hasSimulationResults())
-		emit movesChanged(m_simulator->moves(/* prune */ true, /* sort by win */ true));
-	else
-		emit movesChanged(m_game->currentPosition().moves());
+	const SimThread::Snapshot snapshot = m_simThread->snapshot();
+	const Quackle::MoveList &moves = snapshot.iterations > 0? snapshot.moves : m_game->currentPosition().moves();
+
+	emit movesChanged(moves);
 
 	m_simulateAction->setEnabled(!m_game->currentPosition().moves().empty());
 	m_simulateDetailsAction->setEnabled(!m_game->currentPosition().moves().empty());
@@ -1008,6 +1018,7 @@ void TopLevel::commitTopChoice()
 
 void TopLevel::ensureUpToDateSimulatorMoveList()
 {
+	SimThread::Locker locker(m_simThread);
 	m_simulator->setIncludedMoves(m_game->currentPosition().moves());
 }
 
@@ -1022,10 +1033,17 @@ void TopLevel::simulate(bool startSimulation)
 	if (startSimulation)
 	{
 		logfileChanged();
-		incrementSimulation();
+		m_simThread->simulate(m_plies);
+		m_simulationTimer->start();
 	}
-	else
+	else if (m_simulationTimer->isActive())
+	{
+		m_simThread->pause();
 		m_simulationTimer->stop();
+
+		// show what the last batches added
+		refreshSimulation();
+	}
 }
 
 void TopLevel::simulateToggled(bool startSimulation)
@@ -1050,7 +1068,10 @@ void TopLevel::clearSimulationResults()
 	if (!m_game->hasPositions())
 		return;
 
-	m_simulator->resetNumbers();
+	{
+		SimThread::Locker locker(m_simThread);
+		m_simulator->resetNumbers();
+	}
 
 	updateMoveViews();
 	updateSimViews();
@@ -1067,10 +1088,13 @@ void TopLevel::pliesSet(const QString &plyString)
 		m_plies = -1;
 	else
 		m_plies = plyString.toInt();
+
+	m_simThread->setPlies(m_plies);
 }
 
 void TopLevel::ignoreOpposChanged()
 {
+	SimThread::Locker locker(m_simThread);
 	m_simulator->setIgnoreOppos(m_ignoreOpposCheck->isChecked());
 }
 
@@ -1117,6 +1141,7 @@ QString TopLevel::logfile() const
 
 void TopLevel::logfileChanged()
 {
+	SimThread::Locker locker(m_simThread);
 	m_simulator->setLogfile(QuackleIO::Util::qstringToStdString(logfile()), /* append */ true);
 }
 
@@ -1191,6 +1216,7 @@ void TopLevel::partialOppoRackChanged()
 		return;
 	}
 
+	SimThread::Locker locker(m_simThread);
 	m_simulator->setPartialOppoRack(rack);
 }
 
@@ -1199,32 +1225,25 @@ void TopLevel::showSimulationDetails()
 	if (!m_simViewer)
 		m_simViewer = new SimViewer(this);
 
-	m_simViewer->setSimulator(*m_simulator);
 	m_simViewer->show();
 
 	updateSimViews();
 }
 
-void TopLevel::incrementSimulation()
+void TopLevel::refreshSimulation()
 {
-	if (m_simulateAction->isChecked())
-	{
-		m_simulator->simulate(m_plies);
-		m_simulationTimer->start(0);
-
-		if (m_simulator->iterations() % 10 == 0)
-			updateMoveViews();
-
-		updateSimViews();
-	}
+	updateMoveViews();
+	updateSimViews();
 }
 
 void TopLevel::updateSimViews()
 {
-	m_simulatorWidget->setTitle(m_simulator->hasSimulationResults()? tr("Simulation: %2 iterations").arg(m_simulator->iterations()) : tr("Simulation"));
+	const SimThread::Snapshot snapshot = m_simThread->snapshot();
+
+	m_simulatorWidget->setTitle(snapshot.iterations > 0? tr("Simulation: %2 iterations").arg(snapshot.iterations) : tr("Simulation"));
 
 	if (m_simViewer && m_simViewer->isVisible())
-		m_simViewer->setSimulator(*m_simulator);
+		m_simViewer->setSimulation(snapshot);
 }
 
 void TopLevel::loadFile(const QString &filename)
@@ -1519,7 +1538,10 @@ void TopLevel::showToHuman()
 	// make sure that the internal order of rack is how user likes it
 	m_game->currentPosition().setCurrentPlayerRack(rack);
 
-	m_simulator->setPosition(m_game->currentPosition());
+	{
+		SimThread::Locker locker(m_simThread);
+		m_simulator->setPosition(m_game->currentPosition());
+	}
 
 	updateHistoryViews();
 	updatePositionViews();
@@ -26,6 +26,7 @@
 
 #include <datamanager.h>
 #include "oppothread.h"
+#include "simthread.h"
 #include <sim.h>
 
 #include <quackleio/dictimplementation.h>
@@ -210,8 +211,9 @@ protected slots:
 	// main timer
 	void timeout();
 
-	// simulation timer
-	void incrementSimulation();
+	// simulation timer; updates views of the simulation
+	// running on m_simThread
+	void refreshSimulation();
 	void updateSimViews();
 
 	// simulator settings:
@@ -246,6 +248,11 @@ protected:
 	Quackle::Game *m_game;
 	Quackle::Simulator *m_simulator;
 
+	// Simulates with m_simulator. While it runs, m_simulator is
+	// only to be changed under a SimThread::Locker, and views read
+	// its results from the thread's snapshot.
+	SimThread *m_simThread;
+
 private:
 	void saveSettings();
 	void loadSettings();
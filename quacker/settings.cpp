@@ -256,9 +256,16 @@ void Settings::buildGaddag()
 		setGaddagLabel(QString(tr("Lexicon total: %1 words.  Compressing...")).arg(wordCount));
 		factory.generate();
 		setGaddagLabel(QString(tr("Lexicon total: %1 words.  Writing to disk...")).arg(wordCount));
-		factory.writeIndex(gaddagFile);
-		QUACKLE_LEXICON_PARAMETERS->loadGaddag(gaddagFile);
-		setGaddagLabel();
+		if (factory.writeIndex(gaddagFile))
+		{
+			QUACKLE_LEXICON_PARAMETERS->loadGaddag(gaddagFile);
+			setGaddagLabel();
+		}
+		else
+		{
+			QFile::remove(QuackleIO::Util::stdStringToQString(gaddagFile));
+			setGaddagLabel(tr("The lexicon database couldn't be written to disk.  Operation aborted."));
+		}
 	}
 	else
 		setGaddagLabel(tr("Your lexicon is too large to be represented using the internal database format.  Operation aborted."));
@@ -0,0 +1,157 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QElapsedTimer>
+
+#include "oppothread.h"
+#include "simthread.h"
+
+// Batches are sized to take about this long, so that threads are
+// started and joined a few times a second however fast iterations
+// are, and a pause or a Locker waits no longer than this.
+static const qint64 batchMilliseconds = 200;
+
+SimThread::SimThread(Quackle::Simulator *simulator, QObject *parent)
+	: QThread(parent), m_simulator(simulator), m_plies(2), m_paused(false), m_finishing(false), m_batchIterations(0), m_waiting(0)
+{
+	m_dispatch = new QuackerDispatch(this);
+}
+
+SimThread::~SimThread()
+{
+	abort();
+}
+
+void SimThread::run()
+{
+	forever
+	{
+		// let anyone waiting on the simulator have it first
+		while (m_waiting.loadAcquire() > 0)
+			yieldCurrentThread();
+
+		QMutexLocker locker(&m_mutex);
+		if (m_paused || m_dispatch->shouldAbort())
+		{
+			m_finishing = true;
+			break;
+		}
+
+		// at least an iteration for each simulator thread
+		const int threads = m_simulator->threadCount();
+		if (m_batchIterations < threads)
+			m_batchIterations = threads;
+
+		QElapsedTimer timer;
+		timer.start();
+
+		m_simulator->setDispatch(m_dispatch);
+		m_simulator->simulate(m_plies, m_batchIterations);
+		m_simulator->setDispatch(0);
+
+		takeSnapshot();
+
+		const qint64 elapsed = timer.elapsed();
+		if (elapsed < batchMilliseconds / 2)
+			m_batchIterations *= 2;
+		else if (elapsed > batchMilliseconds * 2)
+			m_batchIterations /= 2;
+	}
+}
+
+void SimThread::simulate(int plies)
+{
+	bool running;
+	{
+		Locker locker(this);
+		m_plies = plies;
+		m_paused = false;
+		m_batchIterations = 0;
+		running = isRunning() && !m_finishing;
+	}
+
+	if (running)
+		return;
+
+	// a thread that has already decided to stop is let finish
+	wait();
+
+	m_finishing = false;
+	m_dispatch->setShouldAbort(false);
+	start();
+}
+
+void SimThread::setPlies(int plies)
+{
+	Locker locker(this);
+	m_plies = plies;
+	m_batchIterations = 0;
+}
+
+void SimThread::pause()
+{
+	Locker locker(this);
+	m_paused = true;
+}
+
+void SimThread::abort()
+{
+	m_dispatch->setShouldAbort(true);
+	wait();
+}
+
+SimThread::Snapshot SimThread::snapshot() const
+{
+	QMutexLocker locker(&m_snapshotMutex);
+	return m_snapshot;
+}
+
+void SimThread::takeSnapshot()
+{
+	Snapshot snapshot;
+	snapshot.iterations = m_simulator->iterations();
+	snapshot.moves = m_simulator->moves(/* prune */ true, /* sort by win */ true);
+	snapshot.simmedMoves = m_simulator->simmedMoves();
+
+	// a simulator that has simulated has a player on turn
+	if (m_simulator->hasSimulationResults())
+		snapshot.rack = m_simulator->currentPosition().currentPlayer().rack();
+
+	QMutexLocker locker(&m_snapshotMutex);
+	std::swap(m_snapshot, snapshot);
+}
+
+SimThread::Snapshot::Snapshot()
+	: iterations(0)
+{
+}
+
+SimThread::Locker::Locker(SimThread *thread)
+	: m_thread(thread)
+{
+	m_thread->m_waiting.ref();
+	m_thread->m_mutex.lock();
+	m_thread->m_waiting.deref();
+}
+
+SimThread::Locker::~Locker()
+{
+	m_thread->takeSnapshot();
+	m_thread->m_mutex.unlock();
+}
@@ -0,0 +1,121 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef QUACKER_SIMTHREAD_H
+#define QUACKER_SIMTHREAD_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+
+#include <sim.h>
+
+class QuackerDispatch;
+
+// Runs a simulator off the UI thread, in batches of as many
+// iterations as its threads get through in a fraction of a second,
+// until paused or aborted. Results stay in the simulator, so
+// simulating again resumes where it stopped.
+class SimThread : public QThread
+{
+Q_OBJECT
+
+public:
+	SimThread(Quackle::Simulator *simulator, QObject *parent = 0);
+	~SimThread();
+
+	// starts the thread if it is not running
+	void simulate(int plies);
+
+	// plies of batches from now on
+	void setPlies(int plies);
+
+	// stops after the batch being simulated
+	void pause();
+
+	// stops within the batch being simulated and waits for the
+	// thread to finish
+	void abort();
+
+	// Holds off the simulation for as long as it lives. Take one
+	// before changing the simulator from another thread; the
+	// snapshot is retaken when it goes.
+	class Locker
+	{
+	public:
+		Locker(SimThread *thread);
+		~Locker();
+
+	private:
+		SimThread *m_thread;
+	};
+
+	// the simulator's results as of the last batch or Locker
+	struct Snapshot
+	{
+		Snapshot();
+
+		int iterations;
+
+		// as Simulator::moves(prune, sort by win) gives them
+		Quackle::MoveList moves;
+
+		Quackle::SimmedMoveList simmedMoves;
+		Quackle::Rack rack;
+	};
+
+	// Views read this rather than the simulator, as it never waits
+	// on a batch.
+	Snapshot snapshot() const;
+
+protected:
+	void run();
+
+private:
+	Quackle::Simulator *m_simulator;
+	QuackerDispatch *m_dispatch;
+
+	int m_plies;
+	bool m_paused;
+
+	// set by the thread once it stops taking batches
+	bool m_finishing;
+
+	// iterations in the next batch; zero to start over from one per
+	// simulator thread
+	int m_batchIterations;
+
+	// held while simulating a batch, and by Lockers
+	QMutex m_mutex;
+
+	// Lockers waiting for the mutex, which the thread steps
+	// aside for between batches
+	QAtomicInt m_waiting;
+
+	// copies the simulator's results into m_snapshot; called
+	// holding m_mutex
+	void takeSnapshot();
+
+	Snapshot m_snapshot;
+
+	// held only to copy m_snapshot in or out
+	mutable QMutex m_snapshotMutex;
+};
+
+#endif
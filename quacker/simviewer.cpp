@@ -49,10 +49,10 @@ SimViewer::SimViewer(QWidget *parent)
 	setWindowTitle(tr("Simulation Results - Quackle"));
 }
 
-void SimViewer::setSimulator(const Quackle::Simulator &simulator)
+void SimViewer::setSimulation(const SimThread::Snapshot &snapshot)
 {
-	m_averagesTab->setSimulator(simulator);
-	setWindowTitle(tr("%1 iterations of %2 - Quackle").arg(simulator.iterations()).arg(QuackleIO::Util::letterStringToQString(simulator.currentPosition().currentPlayer().rack().tiles())));
+	m_averagesTab->setSimulation(snapshot);
+	setWindowTitle(tr("%1 iterations of %2 - Quackle").arg(snapshot.iterations).arg(QuackleIO::Util::letterStringToQString(snapshot.rack.tiles())));
 }
 
 /////////////
@@ -72,16 +72,16 @@ AveragesTab::AveragesTab(QWidget *parent)
 	//topLayout->addWidget(explainButton);
 }
 
-void AveragesTab::setSimulator(const Quackle::Simulator &simulator)
+void AveragesTab::setSimulation(const SimThread::Snapshot &snapshot)
 {
 	QString html;
 
-	html += statisticTable(simulator);
+	html += statisticTable(snapshot);
 
 	html += "<hr />";
 
-	const Quackle::SimmedMoveList::const_iterator end(simulator.simmedMoves().end());
-	for (Quackle::SimmedMoveList::const_iterator it = simulator.simmedMoves().begin(); it != end; ++it)
+	const Quackle::SimmedMoveList::const_iterator end(snapshot.simmedMoves.end());
+	for (Quackle::SimmedMoveList::const_iterator it = snapshot.simmedMoves.begin(); it != end; ++it)
 	{
 		if (!(*it).includeInSimulation())
 			continue;
@@ -116,17 +116,22 @@ void AveragesTab::setSimulator(const Quackle::Simulator &simulator)
 	m_textEdit->setHtml(html);
 }
 
-QString AveragesTab::statisticTable(const Quackle::Simulator &simulator)
+QString AveragesTab::statisticTable(const SimThread::Snapshot &snapshot)
 {
 	QString ret;
-	for (int levelIndex = 0; levelIndex < simulator.numLevels(); ++levelIndex)
+	if (snapshot.simmedMoves.empty())
+		return ret;
+
+	// as Simulator::numLevels and numPlayersAtLevel count them
+	const Quackle::LevelList &levels = snapshot.simmedMoves.front().levels;
+	for (int levelIndex = 0; levelIndex < (int)levels.size(); ++levelIndex)
 	{
-		for (int playerIndex = 0; playerIndex < simulator.numPlayersAtLevel(levelIndex); ++playerIndex)
+		for (int playerIndex = 0; playerIndex < (int)levels[levelIndex].statistics.size(); ++playerIndex)
 		{
 			if (levelIndex == 0 && playerIndex == 0)
 				continue;
 
-			const Quackle::SimmedMoveList::const_iterator end(simulator.simmedMoves().end());
+			const Quackle::SimmedMoveList::const_iterator end(snapshot.simmedMoves.end());
 			
 			// Little bit of fudgery so that the turn after our next turn is #2,
 			// and turn after oppo's next turn is also #2.
@@ -144,7 +149,7 @@ QString AveragesTab::statisticTable(const Quackle::Simulator &simulator)
 			
 			ret += "<table border=0 cellspacing=4>";
 			ret += tr("<tr><th>Candidate</th><th>Score</th><th>Std. Dev.</th><th>Bingo %</th></tr>");
-			for (Quackle::SimmedMoveList::const_iterator it = simulator.simmedMoves().begin(); it != end; ++it)
+			for (Quackle::SimmedMoveList::const_iterator it = snapshot.simmedMoves.begin(); it != end; ++it)
 			{
 				if (!(*it).includeInSimulation())
 					continue;
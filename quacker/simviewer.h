@@ -21,7 +21,7 @@
 
 #include <QDialog>
 
-#include <sim.h>
+#include "simthread.h"
 
 class QPushButton;
 class QTabWidget;
@@ -38,7 +38,7 @@ public:
 	virtual QSize sizeHint() const;
 
 public slots:
-	void setSimulator(const Quackle::Simulator &simulator);
+	void setSimulation(const SimThread::Snapshot &snapshot);
 
 private:
 	QTabWidget *m_tabs;
@@ -53,9 +53,9 @@ public:
 	AveragesTab(QWidget *parent = 0);
 
 public slots:
-	void setSimulator(const Quackle::Simulator &simulator);
+	void setSimulation(const SimThread::Snapshot &snapshot);
 
-	QString statisticTable(const Quackle::Simulator &simulator);
+	QString statisticTable(const SimThread::Snapshot &snapshot);
 
 	void explain();
 
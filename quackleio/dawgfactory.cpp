@@ -20,6 +20,7 @@
 #include <iomanip>
 #include <ios>
 #include <iostream>
+#include <unordered_map>
 #include <QtCore>
 #include <QCryptographicHash>
 
@@ -86,48 +87,38 @@ void DawgFactory::hashWord(const Quackle::LetterString &word)
 
 void DawgFactory::generate()
 {
-	const int bucketcount = 2000;
-	vector< int > bucket[bucketcount];
-
 	m_nodelist.clear();
 	m_nodelist.push_back(&m_root);
 	m_root.print(m_nodelist);
 
-	m_nodelist[0]->letterSum();
+	// Nodes are equal when their letters, playabilities, smaller-dict
+	// flags and children are, so numbering classes of equal nodes
+	// children first lets each node be looked up by its letter and
+	// flags and its children's classes. Children follow their parents
+	// in m_nodelist, so walking it backwards numbers them first and
+	// leaves each class with its earliest node, which is the one kept.
+	std::unordered_map<std::string, int> registry;
+	vector< Node* > firstOfClass;
 
-	for (unsigned int i = 0; i < m_nodelist.size(); i++)
+	for (int i = m_nodelist.size() - 1; i >= 0; i--)
 	{
-		bucket[m_nodelist[i]->sum % bucketcount].push_back(i);
-		m_nodelist[i]->pointer = 0;
-		m_nodelist[i]->written = false;
-		m_nodelist[i]->deleted = false;
-		m_nodelist[i]->cloneof = NULL;
+		Node *n = m_nodelist[i];
+		const std::pair<std::unordered_map<std::string, int>::iterator, bool> found = registry.insert(make_pair(n->signature(), (int)firstOfClass.size()));
+		n->equivalenceClass = found.first->second;
+		if (found.second)
+			firstOfClass.push_back(n);
+		else
+			firstOfClass[n->equivalenceClass] = n;
 	}
 
-	for (int b = 0; b < bucketcount; b++)
+	for (unsigned int i = 0; i < m_nodelist.size(); i++)
 	{
-		if (bucket[b].size() == 0)
-			continue;
-		for (vector<int>::iterator it = bucket[b].begin(); it != bucket[b].end() - 1; it++)
-		{
-			if (!m_nodelist[(*it)]->deleted)
-			{	
-				for (vector<int>::iterator jt = it + 1; jt != bucket[b].end(); jt++)
-				{
-					if (!m_nodelist[(*jt)]->deleted)
-					{
-						// cout << "Comparing " << (*it) << " and " << (*jt) << endl;
-						if (m_nodelist[(*it)]->equals(m_nodelist[(*jt)][0]))
-						{
-							//cout << "Hey! " << (*it) << " == " << (*jt) << endl;
-							// ones[l].erase(jt);
-							m_nodelist[(*jt)]->deleted = true;
-							m_nodelist[(*jt)]->cloneof = m_nodelist[(*it)];
-						}
-					}
-				}
-			}
-		}
+		Node *n = m_nodelist[i];
+		Node *first = firstOfClass[n->equivalenceClass];
+		n->pointer = 0;
+		n->written = false;
+		n->deleted = (first != n);
+		n->cloneof = n->deleted? first : NULL;
 	}
 	
 	m_nodelist.clear();
@@ -138,13 +129,18 @@ void DawgFactory::generate()
 void DawgFactory::writeIndex(const string &filename)
 {
 	ofstream out(filename.c_str(), ios::out | ios::binary);
-	unsigned char bytes[7];
+	unsigned char bytes[8];
+
+	// pointers are indexes into m_nodelist; version 1 is kept for
+	// every dawg whose pointers fit in 24 bits
+	const bool wide = m_nodelist.size() > 0x00FFFFFF;
+	const int nodeSize = wide? 8 : 7;
 
 	bytes[0] = (m_encodableWords & 0x00FF0000) >> 16;
 	bytes[1] = (m_encodableWords & 0x0000FF00) >>  8;
 	bytes[2] = (m_encodableWords & 0x000000FF);
 
-	out.put(1); // DAWG format version 1
+	out.put(wide? 2 : 1); // DAWG format version
 	out.write(m_hash.charptr, sizeof(m_hash.charptr));
 	out.write((char*)bytes, 3);
 	out.put((char)m_alphas->length());
@@ -168,24 +164,29 @@ void DawgFactory::writeIndex(const string &filename)
 		else
 			p = (unsigned int)(m_nodelist[i]->pointer);
 
-		bytes[0] = (p & 0x00FF0000) >> 16;
-		bytes[1] = (p & 0x0000FF00) >>  8;
-		bytes[2] = (p & 0x000000FF);
-		bytes[3] = n->c - QUACKLE_FIRST_LETTER;
+		int k = 0;
+		if (wide)
+			bytes[k++] = (p & 0xFF000000) >> 24;
+		bytes[k++] = (p & 0x00FF0000) >> 16;
+		bytes[k++] = (p & 0x0000FF00) >>  8;
+		bytes[k++] = (p & 0x000000FF);
+
+		unsigned char &letter = bytes[k++];
+		letter = n->c - QUACKLE_FIRST_LETTER;
 				
 		unsigned int pb = n->playability;
-		bytes[4] = (pb & 0x00FF0000) >> 16;
-		bytes[5] = (pb & 0x0000FF00) >>  8;
-		bytes[6] = (pb & 0x000000FF);
+		bytes[k++] = (pb & 0x00FF0000) >> 16;
+		bytes[k++] = (pb & 0x0000FF00) >>  8;
+		bytes[k++] = (pb & 0x000000FF);
 
 		if (n->lastchild) {
-			bytes[3] |= 64;
+			letter |= 64;
 		}
 		if (n->insmallerdict) {
-			bytes[3] |= 128;
+			letter |= 128;
 		}
 
-		out.write((char*)bytes, 7);
+		out.write((char*)bytes, nodeSize);
 	}
 }
 
@@ -282,45 +283,20 @@ bool DawgFactory::Node::pushWord(const Quackle::LetterString &word, bool inSmall
 		added = children[index].pushWord(rest, inSmaller, pb);
 	}
 
-	sumexplored = false;
 	deleted = false;
 	written = false;
 	return added;
 }
 
 
-bool DawgFactory::Node::equals(const Node &n) const
+std::string DawgFactory::Node::signature() const
 {
-	if (playability != n.playability)
-		return false;
-	if (c != n.c)
-		return false;
-	if (children.size() != n.children.size())
-		return false;
-	if (insmallerdict != n.insmallerdict)
-		return false;
-	if (sum != n.sum)
-		return false;
-
+	std::string ret;
+	ret.reserve(6 + 4 * children.size());
+	ret.push_back(c);
+	ret.push_back(insmallerdict);
+	ret.append((const char *)&playability, sizeof(playability));
 	for (unsigned int i = 0; i < children.size(); i++)
-		if (!children[i].equals(n.children[i]))
-			return false;
-	
-	return true;
-}
-
-int DawgFactory::Node::letterSum() const
-{
-	if (sumexplored)
-		return sum;
-	
-	sumexplored = true;
-
-	// djb2 checksum
-	sum = 5381 * 33 + (int) c;
-
-	for (unsigned int i = 0; i < children.size(); i++)
-		sum = (sum << 5) + sum + children[i].letterSum();
-
-	return sum;
+		ret.append((const char *)&children[i].equivalenceClass, sizeof(children[i].equivalenceClass));
+	return ret;
 }
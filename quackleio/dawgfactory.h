@@ -52,8 +52,9 @@ private:
 		bool pushWord(const Quackle::LetterString& word, bool inSmaller, int pb);
 		void print(vector< Node* > &m_nodelist);
 
-		int letterSum() const;
-		bool equals(const Node &n) const;
+		// letter, flags and children's equivalence classes, which
+		// must be set; equal nodes have equal signatures
+		std::string signature() const;
 
 		Quackle::Letter c;
 		bool insmallerdict;
@@ -65,10 +66,7 @@ private:
 
 		bool lastchild;
 
-		mutable bool sumexplored;
-		mutable unsigned int sum;
-		mutable vector<int> counts;
-			
+		int equivalenceClass;
 		bool deleted;
 		Node* cloneof;
 		bool written;
@@ -18,14 +18,16 @@
 
 
 #include <iostream>
+#include <thread>
 #include <QtCore>
 #include <QCryptographicHash>
 
+#include "gaddag.h"
 #include "gaddagfactory.h"
 #include "util.h"
 
 GaddagFactory::GaddagFactory(const UVString &alphabetFile)
-	: m_encodableWords(0), m_unencodableWords(0), m_alphas(NULL)
+	: m_encodableWords(0), m_unencodableWords(0), m_mappable(false), m_alphas(NULL), m_nodeCount(0)
 {
 	if (!alphabetFile.empty())
 	{
@@ -34,12 +36,6 @@ GaddagFactory::GaddagFactory(const UVString &alphabetFile)
 		m_alphas = flexure;
 	}
 
-	// So the separator is sorted to last.
-	m_root.t = false;
-	m_root.c = QUACKLE_NULL_MARK;  // "_"
-	m_root.pointer = 0;
-	m_root.lastchild = true;
-
 	m_hash.int32ptr[0] = m_hash.int32ptr[1] = m_hash.int32ptr[2] = m_hash.int32ptr[3] = 0;
 }
 
@@ -70,22 +66,37 @@ bool GaddagFactory::pushWord(const Quackle::LetterString &word)
 	// But testing for duplicate words isn't so easy without keeping
 	// an entirely separate list.
 
-	for (unsigned i = 1; i <= word.length(); i++)
+	m_words.push_back(word.length());
+	m_words.append(word.begin(), word.end());
+	return true;
+}
+
+void GaddagFactory::gaddagize(const vector<Occurrence> &occurrences, Quackle::WordList &gaddagized) const
+{
+	gaddagized.clear();
+	gaddagized.reserve(occurrences.size());
+
+	for (size_t k = 0; k < occurrences.size(); k++)
 	{
+		const unsigned int length = (unsigned char)m_words[occurrences[k].word];
+		const char *word = m_words.data() + occurrences[k].word + 1;
+		const unsigned int i = occurrences[k].index + 1;
+
 		Quackle::LetterString newword;
 
 		for (int j = i - 1; j >= 0; j--)
 			newword.push_back(word[j]);
 
-		if (i < word.length())
+		if (i < length)
 		{
 			newword.push_back(internalSeparatorRepresentation);  // "^"
-			for (unsigned j = i; j < word.length(); j++)
+			for (unsigned j = i; j < length; j++)
 				newword.push_back(word[j]);
 		}
-		m_gaddagizedWords.push_back(newword);
+		gaddagized.push_back(newword);
 	}
-	return true;
+
+	sort(gaddagized.begin(), gaddagized.end());
 }
 
 void GaddagFactory::hashWord(const Quackle::LetterString &word)
@@ -101,100 +112,249 @@ void GaddagFactory::hashWord(const Quackle::LetterString &word)
 
 void GaddagFactory::generate()
 {
-	sort(m_gaddagizedWords.begin(), m_gaddagizedWords.end());
-	Quackle::WordList::const_iterator wordsEnd = m_gaddagizedWords.end();
-	for (Quackle::WordList::const_iterator wordsIt = m_gaddagizedWords.begin(); wordsIt != wordsEnd; ++wordsIt)
-		m_root.pushWord(*wordsIt);
-	//	for (const auto& words : gaddaggizedWords)
-	//		m_root.pushWord(words);
-}
+	m_siblingLists.clear();
+	m_freeSiblingLists.clear();
+	m_register.clear();
+	m_path.clear();
+	m_lastWord.clear();
+
+	m_path.push_back(newSiblingList());
+
+	// Every gaddagization starts with a letter, so taking them one
+	// first letter at a time adds them all in order without holding
+	// them all at once. One pass over the words finds where each
+	// letter occurs. The next letter's are made on another thread
+	// while this letter's are added.
+	vector<vector<Occurrence> > occurrences(QUACKLE_MAXIMUM_ALPHABET_SIZE);
+	for (size_t at = 0; at < m_words.size(); at += 1 + (unsigned char)m_words[at])
+	{
+		const unsigned int length = (unsigned char)m_words[at];
+		for (unsigned int i = 0; i < length; i++)
+		{
+			const unsigned int letter = (Quackle::Letter)m_words[at + 1 + i] - QUACKLE_FIRST_LETTER;
+			if (letter < occurrences.size())
+			{
+				Occurrence occurrence;
+				occurrence.word = at;
+				occurrence.index = i;
+				occurrences[letter].push_back(occurrence);
+			}
+		}
+	}
 
-void GaddagFactory::writeIndex(const string &fname)
-{
-	m_nodelist.push_back(&m_root);
+	vector<int> firsts;
+	for (size_t letter = 0; letter < occurrences.size(); letter++)
+		if (!occurrences[letter].empty())
+			firsts.push_back(letter);
 
-	m_root.print(m_nodelist);    
+	Quackle::WordList gaddagized;
+	Quackle::WordList nextGaddagized;
+	if (!firsts.empty())
+		gaddagize(occurrences[firsts[0]], gaddagized);
 
-	ofstream out(fname.c_str(), ios::out | ios::binary);
+	for (size_t i = 0; i < firsts.size(); ++i)
+	{
+		std::thread next;
+		if (i + 1 < firsts.size())
+			next = std::thread(&GaddagFactory::gaddagize, this, std::cref(occurrences[firsts[i + 1]]), std::ref(nextGaddagized));
 
-	out.put(1); // GADDAG format version 1
-	out.write(m_hash.charptr, sizeof(m_hash.charptr));
+		Quackle::WordList::const_iterator wordsEnd = gaddagized.end();
+		for (Quackle::WordList::const_iterator wordsIt = gaddagized.begin(); wordsIt != wordsEnd; ++wordsIt)
+			addWord(*wordsIt);
 
-	for (size_t i = 0; i < m_nodelist.size(); i++)
+		if (next.joinable())
+			next.join();
+		gaddagized.swap(nextGaddagized);
+
+		vector<Occurrence>().swap(occurrences[firsts[i]]);
+	}
+
+	minimizePath(0);
+	m_register.clear();
+
+	// Node pointers only point forward, so every sibling list goes
+	// after all the lists with nodes that point to it. The root node
+	// comes first of all.
+	vector<char> visited(m_siblingLists.size(), false);
+	vector<int> postorder;
+	layOut(0, visited, postorder);
+
+	m_order.assign(postorder.rbegin(), postorder.rend());
+	m_offsets.assign(m_siblingLists.size(), 0);
+	m_nodeCount = 1;
+	for (size_t i = 0; i < m_order.size(); i++)
 	{
-		unsigned int p = (unsigned int)(m_nodelist[i]->pointer);
-		if (p != 0)
-			p -= i; // offset indexing
+		m_offsets[m_order[i]] = m_nodeCount;
+		m_nodeCount += m_siblingLists[m_order[i]].size();
+	}
+}
 
-		char bytes[4];
-		unsigned char n1 = (p & 0x00FF0000) >> 16;
-		unsigned char n2 = (p & 0x0000FF00) >> 8;
-		unsigned char n3 = (p & 0x000000FF) >> 0;
-		unsigned char n4; 
+void GaddagFactory::addWord(const Quackle::LetterString &word)
+{
+	if (word.length() == 0)
+		return;
 
-		n4 = m_nodelist[i]->c;
-		if (n4 == internalSeparatorRepresentation)
-			n4 = QUACKLE_NULL_MARK;
+	unsigned int prefix = 0;
+	while (prefix < word.length() && prefix < m_lastWord.length() && word[prefix] == m_lastWord[prefix])
+		prefix++;
 
-		if (m_nodelist[i]->t)
-			n4 |= 64;
+	minimizePath(prefix);
 
-		if (m_nodelist[i]->lastchild)
-			n4 |= 128;
+	for (unsigned int i = prefix; i < word.length(); i++)
+	{
+		if (i == m_path.size())
+		{
+			const int list = newSiblingList();
+			m_siblingLists[m_path.back()].back().children = list;
+			m_path.push_back(list);
+		}
 
-		bytes[0] = n1; bytes[1] = n2; bytes[2] = n3; bytes[3] = n4;
-		out.write(bytes, 4);
+		Node n;
+		n.c = word[i];
+		n.t = false;
+		n.children = -1;
+		m_siblingLists[m_path[i]].push_back(n);
 	}
+
+	m_siblingLists[m_path[word.length() - 1]].back().t = true;
+	m_lastWord = word;
 }
 
+void GaddagFactory::minimizePath(unsigned int depth)
+{
+	while (m_path.size() > depth + 1)
+	{
+		const int list = m_path.back();
+		m_path.pop_back();
 
-void GaddagFactory::Node::print(vector< Node* >& nodelist)
+		const std::pair<std::unordered_map<std::string, int>::iterator, bool> registered = m_register.insert(std::make_pair(signature(m_siblingLists[list]), list));
+		if (!registered.second)
+		{
+			m_siblingLists[m_path.back()].back().children = registered.first->second;
+			m_siblingLists[list].clear();
+			m_freeSiblingLists.push_back(list);
+		}
+	}
+}
+
+int GaddagFactory::newSiblingList()
+{
+	if (!m_freeSiblingLists.empty())
+	{
+		const int list = m_freeSiblingLists.back();
+		m_freeSiblingLists.pop_back();
+		return list;
+	}
+
+	m_siblingLists.push_back(SiblingList());
+	return m_siblingLists.size() - 1;
+}
+
+std::string GaddagFactory::signature(const SiblingList &list) const
 {
-	if (children.size() > 0)
+	std::string ret;
+	ret.reserve(list.size() * (2 + sizeof(int)));
+	for (size_t i = 0; i < list.size(); i++)
 	{
-		pointer = nodelist.size();
-		children[children.size() - 1].lastchild = true;
+		ret.push_back(list[i].c);
+		ret.push_back(list[i].t);
+		ret.append((const char *)&list[i].children, sizeof(int));
 	}
+	return ret;
+}
+
+void GaddagFactory::layOut(int list, vector<char> &visited, vector<int> &postorder) const
+{
+	visited[list] = true;
 
-	for (size_t i = 0; i < children.size(); i++)
-		nodelist.push_back(&children[i]);
+	const SiblingList &siblings = m_siblingLists[list];
+	for (size_t i = 0; i < siblings.size(); i++)
+		if (siblings[i].children >= 0 && !visited[siblings[i].children])
+			layOut(siblings[i].children, visited, postorder);
 
-	for (size_t i = 0; i < children.size(); i++)
-		children[i].print(nodelist);
+	postorder.push_back(list);
 }
 
+uint64_t GaddagFactory::childMask(int list) const
+{
+	uint64_t mask = 0;
+	const SiblingList &siblings = m_siblingLists[list];
+	for (size_t i = 0; i < siblings.size(); i++)
+		mask |= Quackle::GaddagNode::letterBit(siblings[i].c == internalSeparatorRepresentation? QUACKLE_GADDAG_SEPARATOR : siblings[i].c);
+	return mask;
+}
 
-void GaddagFactory::Node::pushWord(const Quackle::LetterString& word)
+// Writes a node as a gaddag of version holds it. v1 and v2 store the
+// pointer big-endian in 24 or 32 bits, then the node's byte. v3
+// stores the pointer, then the child mask with the node's byte on
+// top, both little-endian.
+static void writeNode(ofstream &out, int version, uint32_t p, unsigned char n, uint64_t mask)
 {
-	if (word.length() == 0)
+	if (version == 3)
 	{
-		t = true;
+		const uint64_t word = mask | ((uint64_t)n << 56);
+
+		char bytes[12];
+		for (int k = 0; k < 4; k++)
+			bytes[k] = (p >> (8 * k)) & 0xFF;
+		for (int k = 0; k < 8; k++)
+			bytes[4 + k] = (word >> (8 * k)) & 0xFF;
+		out.write(bytes, sizeof(bytes));
 		return;
 	}
 
-	Quackle::Letter first = Quackle::String::front(word);
-	Quackle::LetterString rest = Quackle::String::allButFront(word);
-	int index = -1;
+	char bytes[5];
+	int k = 0;
+	if (version == 2)
+		bytes[k++] = (p & 0xFF000000) >> 24;
+	bytes[k++] = (p & 0x00FF0000) >> 16;
+	bytes[k++] = (p & 0x0000FF00) >> 8;
+	bytes[k++] = (p & 0x000000FF) >> 0;
+	bytes[k++] = n;
+	out.write(bytes, k);
+}
 
-	for (size_t i = 0; i < children.size(); i++)
+bool GaddagFactory::writeIndex(const string &fname)
+{
+	ofstream out(fname.c_str(), ios::out | ios::binary);
+
+	// Pointers are relative and point forward, so none is as large as
+	// the node count. Version 1 is kept for every gaddag it can hold
+	// so that older readers can load them.
+	const int version = m_mappable? 3 : m_nodeCount > 0x00FFFFFF? 2 : 1;
+
+	out.put(version); // GADDAG format version
+	out.write(m_hash.charptr, sizeof(m_hash.charptr));
+
+	// the root, whose children are the first list written
+	writeNode(out, version, m_siblingLists[0].empty()? 0 : 1, QUACKLE_NULL_MARK | 128, childMask(0));
+
+	int index = 1;
+	for (size_t i = 0; i < m_order.size(); i++)
 	{
-		if (children[i].c == first)
+		const SiblingList &siblings = m_siblingLists[m_order[i]];
+		for (size_t j = 0; j < siblings.size(); j++, index++)
 		{
-			index = i;
-			i = children.size();
-		}
-	}
+			unsigned int p = 0;
+			if (siblings[j].children >= 0)
+				p = m_offsets[siblings[j].children] - index; // offset indexing
 
-	if (index == -1)
-	{
-		Node n;
-		n.c = first;
-		n.t = false;
-		n.pointer = 0;
-		n.lastchild = false;
-		children.push_back(n);
-		index = children.size() - 1;
+			unsigned char n;
+
+			n = siblings[j].c;
+			if (n == internalSeparatorRepresentation)
+				n = QUACKLE_NULL_MARK;
+
+			if (siblings[j].t)
+				n |= 64;
+
+			if (j == siblings.size() - 1)
+				n |= 128;
+
+			writeNode(out, version, p, n, siblings[j].children >= 0? childMask(siblings[j].children) : 0);
+		}
 	}
 
-	children[index].pushWord(rest);
+	out.close();
+	return !out.fail();
 }
@@ -20,12 +20,14 @@
 #define QUACKLE_GADDAGFACTORY_H
 
 #include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "flexiblealphabet.h"
 
-// This isn't a strict maximum...you can go higher...but too much higher, and you risk overflowing
-// node pointers, which will get you garbage words.  The OSPS dictionary is known to trigger
-// such overflows.
-const int QUACKLE_MAX_GADDAG_WORDCOUNT = 500000;
+// This isn't a strict maximum...you can go higher. Gaddags too big for 24-bit node pointers
+// are written in the wide v2 format, so this is only a bound on time and memory.
+const int QUACKLE_MAX_GADDAG_WORDCOUNT = 5000000;
 
 class GaddagFactory {
 public:
@@ -35,39 +37,93 @@ public:
 	GaddagFactory(const UVString &alphabetFile);
 	~GaddagFactory();
 
-	int wordCount() const { return m_gaddagizedWords.size(); };
-	int nodeCount() const { return m_nodelist.size(); };
+	int wordCount() const { return m_encodableWords; };
+	// number of nodes writeIndex will write; valid after generate()
+	int nodeCount() const { return m_nodeCount; };
 	int encodableWords() const { return m_encodableWords; };
 	int unencodableWords() const { return m_unencodableWords; };
 
 	bool pushWord(const UVString &word);
 	bool pushWord(const Quackle::LetterString &word);
 	void hashWord(const Quackle::LetterString &word);
-	void sortWords() { sort(m_gaddagizedWords.begin(), m_gaddagizedWords.end()); };
+
+	// Builds a minimal gaddag: subtrees that are equal are stored once.
+	// Words may have been pushed in any order.
 	void generate();
-	void writeIndex(const string &fname);
+
+	// Writes a v1 gaddag, or a v2 one with 32-bit node pointers if
+	// nodeCount() needs more than 24 bits, or a v3 one if mappable.
+	// Returns false if the file couldn't be written.
+	bool writeIndex(const string &fname);
+
+	// Whether writeIndex writes v3, whose nodes are stored as
+	// Quackle::GaddagNode holds them so that loading can map the file
+	// rather than expand it. Off by default, as v3 files are three
+	// times the size and older builds can't read them.
+	void setMappable(bool mappable) { m_mappable = mappable; };
+	bool isMappable() const { return m_mappable; };
 
 	const char* hashBytes() { return m_hash.charptr; };
 
 
 private:
-	class Node {
-		public:
-			Quackle::Letter c;
-			bool t;
-			vector<Node> children;
-			int pointer;
-			bool lastchild;
-			void pushWord(const Quackle::LetterString& word);
-			void print(vector< Node* >& m_nodelist);
+	// A node as it is written to the gaddag file. Its children are
+	// a sibling list that other nodes may share.
+	struct Node {
+		Quackle::Letter c;
+		bool t;
+		int children; // index into m_siblingLists, or -1 if none
+	};
+	typedef vector<Node> SiblingList;
+
+	// Adds a gaddagized word, which must sort at or after the one
+	// before, keeping all but the sibling lists along it minimal
+	void addWord(const Quackle::LetterString &word);
+
+	// Shares or registers the sibling lists along the last word
+	// added that are deeper than depth, deepest first
+	void minimizePath(unsigned int depth);
+
+	int newSiblingList();
+	std::string signature(const SiblingList &list) const;
+
+	// a letter of a word pushed: the word's offset in m_words and
+	// the letter's index in the word
+	struct Occurrence {
+		std::uint32_t word;
+		unsigned char index;
 	};
 
+	// the sorted gaddagizations that start at each of occurrences
+	void gaddagize(const vector<Occurrence> &occurrences, Quackle::WordList &gaddagized) const;
+
+	// lays out lists reachable from list, children after parents
+	void layOut(int list, vector<char> &visited, vector<int> &postorder) const;
+
+	// the GaddagNode::childMask of a node whose children are list
+	uint64_t childMask(int list) const;
+
 	int m_encodableWords;
 	int m_unencodableWords;
-	Quackle::WordList m_gaddagizedWords;
-	vector< Node* > m_nodelist;
+	bool m_mappable;
+	// each word pushed, after a byte holding its length
+	std::string m_words;
 	Quackle::AlphabetParameters *m_alphas;
-	Node m_root;
+
+	// m_siblingLists[0] holds the children of the root
+	vector<SiblingList> m_siblingLists;
+	vector<int> m_freeSiblingLists;
+	std::unordered_map<std::string, int> m_register;
+
+	// sibling lists holding each letter of m_lastWord
+	vector<int> m_path;
+	Quackle::LetterString m_lastWord;
+
+	// where each sibling list is written, in nodes from the root
+	vector<int> m_order;
+	vector<int> m_offsets;
+	int m_nodeCount;
+
 	union {
 		char charptr[16];
 		std::int32_t int32ptr[4];
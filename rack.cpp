@@ -92,7 +92,9 @@ bool Rack::contains(const LetterString &used) const
 
 void Rack::shuffle()
 {
-	random_shuffle(m_tiles.begin(), m_tiles.end());
+	LetterString::iterator tiles = m_tiles.begin();
+	for (int i = (int)m_tiles.length() - 1; i > 0; --i)
+		swap(tiles[i], tiles[DataManager::self()->randomNumber(i + 1)]);
 }
 
 int Rack::score() const
@@ -0,0 +1,66 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "randomgenerator.h"
+
+using namespace Quackle;
+
+RandomGenerator::RandomGenerator(uint64_t seed)
+{
+	this->seed(seed);
+}
+
+void RandomGenerator::seed(uint64_t seed)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		seed += 0x9e3779b97f4a7c15ULL;
+		uint64_t z = seed;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		m_state[i] = z ^ (z >> 31);
+	}
+}
+
+void RandomGenerator::jump()
+{
+	static const uint64_t jumpPolynomial[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+	uint64_t jumped[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int bit = 0; bit < 64; ++bit)
+		{
+			if (jumpPolynomial[i] & (1ULL << bit))
+				for (int j = 0; j < 4; ++j)
+					jumped[j] ^= m_state[j];
+			next();
+		}
+	}
+
+	for (int j = 0; j < 4; ++j)
+		m_state[j] = jumped[j];
+}
+
+RandomGenerator RandomGenerator::substream(uint64_t seed, int index)
+{
+	RandomGenerator ret(seed);
+	for (int i = 0; i < index; ++i)
+		ret.jump();
+	return ret;
+}
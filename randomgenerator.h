@@ -0,0 +1,91 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUACKLE_RANDOMGENERATOR_H
+#define QUACKLE_RANDOMGENERATOR_H
+
+#include <cstdint>
+
+namespace Quackle
+{
+
+// xoshiro256** generator. Cheap to copy, so every thread or
+// simulation iteration can carry a stream of its own.
+class RandomGenerator
+{
+public:
+	// seeds via splitmix64 so that nearby seeds give unrelated streams
+	RandomGenerator(uint64_t seed = 0);
+	void seed(uint64_t seed);
+
+	uint64_t next();
+
+	// uniform in [0, bound) without modulo bias; bound must be positive
+	uint32_t bounded(uint32_t bound);
+
+	// Advances the stream by 2^128 draws. Streams that are successive
+	// jumps from one seed never overlap in practice.
+	void jump();
+
+	// The stream reached from seed after index jumps, which costs
+	// index jumps of 256 draws each. For a run of streams in turn,
+	// jump one generator along instead, as Simulator does for its
+	// iterations; this is for going straight to one of them.
+	static RandomGenerator substream(uint64_t seed, int index);
+
+private:
+	uint64_t m_state[4];
+};
+
+inline uint64_t RandomGenerator::next()
+{
+	const uint64_t result = m_state[1] * 5;
+	const uint64_t rotated = (result << 7) | (result >> 57);
+	const uint64_t t = m_state[1] << 17;
+
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+	m_state[2] ^= t;
+	m_state[3] = (m_state[3] << 45) | (m_state[3] >> 19);
+
+	return rotated * 9;
+}
+
+inline uint32_t RandomGenerator::bounded(uint32_t bound)
+{
+	// Lemire's multiply-and-reject
+	uint64_t product = (next() >> 32) * bound;
+	uint32_t low = (uint32_t)product;
+	if (low < bound)
+	{
+		const uint32_t threshold = (uint32_t)(-bound) % bound;
+		while (low < threshold)
+		{
+			product = (next() >> 32) * bound;
+			low = (uint32_t)product;
+		}
+	}
+
+	return (uint32_t)(product >> 32);
+}
+
+}
+
+#endif
@@ -20,9 +20,11 @@
 #include <time.h>
 
 #include "bogowinplayer.h"
+#include "datamanager.h"
 #include "endgameplayer.h"
 #include "preendgame.h"
 #include "resolvent.h"
+#include "resultcache.h"
 
 using namespace Quackle;
 
@@ -43,15 +45,32 @@ Move Resolvent::move()
 
 MoveList Resolvent::moves(int nmoves)
 {
+    DataManagerScope scope(dataManager());
     // UVcout << "Resolvent generating move from position:" << endl;
     // UVcout << m_simulator.currentPosition() << endl;
 
+    // The endgames and preendgames inside another player's
+    // calculations come up again for other candidates and racks,
+    // and on later turns.
+    const bool cacheable = nmoves == 1 && currentPosition().nestedness() > 0 && ResultCache::isCacheable(currentPosition());
+    if (cacheable)
+    {
+        Move cached;
+        if (QUACKLE_RESULT_CACHE->lookUp(currentPosition(), &cached))
+        {
+            MoveList ret;
+            ret.push_back(cached);
+            return ret;
+        }
+    }
+
     ComputerPlayer *delegatee;
 
     if (m_simulator.currentPosition().bag().empty())
     {
-        // Case 1: Straight endgame.
-        delegatee = new EndgamePlayer;
+        // Case 1: Straight endgame. Our endgame player keeps what
+        // it solved from turn to turn.
+        delegatee = &m_endgamePlayer;
     }
     else if (currentPosition().bag().size() <= Preendgame::maximumTilesInBagToEngage())
     {
@@ -69,7 +88,11 @@ MoveList Resolvent::moves(int nmoves)
     delegatee->setPosition(m_simulator.currentPosition());
     delegatee->setConsideredMoves(m_simulator.consideredMoves());
     MoveList moves = delegatee->moves(nmoves);
-    delete delegatee;
+    if (delegatee != &m_endgamePlayer)
+        delete delegatee;
+
+    if (cacheable && !moves.empty())
+        QUACKLE_RESULT_CACHE->store(currentPosition(), moves.back());
 
     return moves;
 }
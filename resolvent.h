@@ -21,6 +21,7 @@
 
 #include "alphabetparameters.h"
 #include "computerplayer.h"
+#include "endgameplayer.h"
 
 namespace Quackle
 {
@@ -37,6 +38,9 @@ public:
 
 	virtual bool isSlow() const;
 	virtual bool isUserVisible() const;
+
+private:
+	EndgamePlayer m_endgamePlayer;
 };
 
 inline bool Resolvent::isUserVisible() const
@@ -0,0 +1,185 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "datamanager.h"
+#include "endgamesolver.h"
+#include "game.h"
+#include "lexiconparameters.h"
+#include "preendgame.h"
+#include "resultcache.h"
+
+using namespace Quackle;
+
+static thread_local ResultCache::Batch *threadBatch = 0;
+
+ResultCache::ResultCache(int capacity)
+	: m_capacity(1), m_size(0), m_lookups(0), m_hits(0)
+{
+	while (m_capacity * 2 <= capacity)
+		m_capacity *= 2;
+}
+
+bool ResultCache::isCacheable(const GamePosition &position)
+{
+	return position.players().size() == 2 && !position.gameOver() && position.bag().size() <= Preendgame::maximumTilesInBagToEngage();
+}
+
+uint64_t ResultCache::key(const GamePosition &position)
+{
+	// The tiles in the bag are the ones neither on the board nor on
+	// a rack. Positions with different spreads or scoreless turns
+	// get unrelated keys, since position keys look random. Nested
+	// preendgames enumerate racks differently at odd nestedness.
+	const int spread = position.spread(position.currentPlayer().id());
+	const bool oddPreendgame = !position.bag().empty() && position.nestedness() % 2;
+	const uint64_t ret = EndgameSolver::positionKey(position) ^ (static_cast<uint64_t>(static_cast<uint32_t>(spread)) | (static_cast<uint64_t>(position.scorelessTurnsInARow()) << 32) | (static_cast<uint64_t>(oddPreendgame) << 40));
+	return ret == 0? 1 : ret;
+}
+
+void ResultCache::checkLexicon()
+{
+	const string lexiconName = QUACKLE_LEXICON_PARAMETERS->lexiconName();
+	if (lexiconName == m_lexiconName)
+		return;
+
+	m_lexiconName = lexiconName;
+	m_entries.clear();
+	m_size = 0;
+}
+
+bool ResultCache::lookUp(const GamePosition &position, Move *move)
+{
+	const uint64_t positionKey = key(position);
+
+	// the batch is only ever used by the calling thread
+	const Entry *found = 0;
+	if (threadBatch)
+	{
+		const unordered_map<uint64_t, int>::const_iterator it = threadBatch->index.find(positionKey);
+		if (it != threadBatch->index.end() && threadBatch->entries[it->second].nestedness <= position.nestedness())
+			found = &threadBatch->entries[it->second];
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+	checkLexicon();
+	++m_lookups;
+
+	if (!found && !m_entries.empty())
+	{
+		const Entry &entry = m_entries[positionKey & (m_capacity - 1)];
+		if (entry.key == positionKey && entry.nestedness <= position.nestedness())
+			found = &entry;
+	}
+
+	if (!found)
+		return false;
+
+	++m_hits;
+	*move = found->move;
+	return true;
+}
+
+void ResultCache::store(const GamePosition &position, const Move &move)
+{
+	Entry entry;
+	entry.key = key(position);
+	entry.nestedness = position.nestedness();
+	entry.move = move;
+
+	if (threadBatch)
+	{
+		// as in place(), a more thorough result for the same
+		// position stays
+		const pair<unordered_map<uint64_t, int>::iterator, bool> indexed = threadBatch->index.insert(make_pair(entry.key, (int)threadBatch->entries.size()));
+		if (!indexed.second)
+		{
+			if (threadBatch->entries[indexed.first->second].nestedness <= entry.nestedness)
+				return;
+			indexed.first->second = threadBatch->entries.size();
+		}
+
+		threadBatch->entries.push_back(entry);
+		return;
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+	checkLexicon();
+	place(entry);
+}
+
+void ResultCache::setThreadBatch(Batch *batch)
+{
+	threadBatch = batch;
+}
+
+void ResultCache::store(const Batch &batch)
+{
+	lock_guard<mutex> lock(m_mutex);
+	checkLexicon();
+
+	for (const auto &it : batch.entries)
+		place(it);
+}
+
+void ResultCache::place(const Entry &entry)
+{
+	// the slots are only made once something is kept
+	if (m_entries.empty())
+		m_entries.resize(m_capacity);
+
+	Entry &slot = m_entries[entry.key & (m_capacity - 1)];
+
+	// a more thorough result for the same position stays
+	if (slot.key == entry.key && slot.nestedness <= entry.nestedness)
+		return;
+
+	if (slot.key == 0)
+		++m_size;
+
+	slot = entry;
+}
+
+void ResultCache::clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_size = 0;
+}
+
+long ResultCache::lookups() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_lookups;
+}
+
+long ResultCache::hits() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_hits;
+}
+
+int ResultCache::size() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_size;
+}
+
+int ResultCache::capacity() const
+{
+	return m_capacity;
+}
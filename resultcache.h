@@ -0,0 +1,119 @@
+/*
+ *  Quackle -- Crossword game artificial intelligence and analysis tool
+ *  Copyright (C) 2005-2014 Jason Katz-Brown and John O'Laughlin.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUACKLE_RESULTCACHE_H
+#define QUACKLE_RESULTCACHE_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "move.h"
+
+using namespace std;
+
+namespace Quackle
+{
+
+class GamePosition;
+
+// Remembers the play resolved for endgames and preendgames met
+// inside the calculations of other players, such as those a
+// preendgame resolves for each of its candidates and racks, so that
+// meeting one again, for another candidate or on a later turn, costs
+// a lookup. Entries are keyed on the board, both racks, the spread
+// and the scoreless turns before, and serve calculations nested at
+// least as deeply as the one that made them, which are no more
+// thorough. A new entry replaces the one in its slot. Entries made
+// with another lexicon are dropped. Safe to use from many threads.
+class ResultCache
+{
+public:
+	struct Entry
+	{
+		Entry() : key(0), nestedness(0) { }
+
+		// zero for an unused slot
+		uint64_t key;
+		unsigned int nestedness;
+		Move move;
+	};
+
+	// entries in the order they were stored, and where the most
+	// thorough one for each key is
+	struct Batch
+	{
+		vector<Entry> entries;
+		unordered_map<uint64_t, int> index;
+	};
+
+	// capacity is rounded down to a power of two
+	ResultCache(int capacity = 1 << 14);
+
+	// whether results for position are ones we keep
+	static bool isCacheable(const GamePosition &position);
+
+	// If there is an entry for position that serves a calculation
+	// at its nestedness, in the cache or the calling thread's batch,
+	// sets move to it and returns true.
+	bool lookUp(const GamePosition &position, Move *move);
+
+	void store(const GamePosition &position, const Move &move);
+
+	// While the calling thread has a batch (until it is set to
+	// zero), what it stores goes to the batch instead, where its
+	// own lookups find it. Callers
+	// running work on many threads give each item a batch, and
+	// store the batches in item order once all are done, so that
+	// what is in the cache, and so what is found, doesn't depend on
+	// which thread finished first.
+	static void setThreadBatch(Batch *batch);
+	void store(const Batch &batch);
+
+	void clear();
+
+	// counts since construction
+	long lookups() const;
+	long hits() const;
+
+	// entries in use, and the most there can be
+	int size() const;
+	int capacity() const;
+
+private:
+	static uint64_t key(const GamePosition &position);
+
+	// puts entry in its slot; call with m_mutex held
+	void place(const Entry &entry);
+
+	// empties the cache if the lexicon changed; call with m_mutex held
+	void checkLexicon();
+
+	mutable mutex m_mutex;
+	vector<Entry> m_entries;
+	int m_capacity;
+	int m_size;
+	long m_lookups;
+	long m_hits;
+	string m_lexiconName;
+};
+
+}
+
+#endif
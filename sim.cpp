@@ -16,8 +16,11 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <math.h>
+#include <thread>
 
 #include "computerplayer.h"
 #include "datamanager.h"
@@ -33,7 +36,7 @@
 using namespace Quackle;
 
 Simulator::Simulator()
-	: m_logfileIsOpen(false), m_hasHeader(false), m_dispatch(0), m_iterations(0), m_ignoreOppos(false)
+	: m_logfileIsOpen(false), m_hasHeader(false), m_dispatch(0), m_dataManager(0), m_iterations(0), m_ignoreOppos(false), m_threadCount(1), m_hasRandomSeed(false), m_randomSeed(0), m_nextStreamIndex(0)
 {
 	m_originalGame.addPosition();
 }
@@ -217,6 +220,14 @@ void Simulator::resetNumbers()
 
 void Simulator::simulate(int plies, int iterations)
 {
+	DataManagerScope scope(m_dataManager);
+
+	if (m_threadCount > 1 && iterations > 1)
+	{
+		simulateInParallel(plies, iterations);
+		return;
+	}
+
 	for (int i = 0; i < iterations; ++i)
 	{
 		if (m_dispatch && m_dispatch->shouldAbort())
@@ -231,13 +242,225 @@ void Simulator::simulate(int plies)
 	UVcout << "let's simulate for " << plies << " plies" << endl;
 #endif
 
+	DataManagerScope scope(m_dataManager);
+	RandomStreamScope streamScope;
+
 	++m_iterations;
 
-	randomizeOppoRacks();
-	randomizeDrawingOrder();
+	if (isLogging() && !m_hasHeader)
+		writeLogHeader();
+
+	const IterationStream stream(takeIterationStream());
+	GamePosition iterationPosition;
+	simulateIteration(iterationPosition, m_playout, m_simmedMoves, plies, stream, m_iterations, isLogging()? &m_logfileStream : 0);
+}
+
+bool Simulator::race(int plies, int iterations, bool byWin, int batchSize, double z)
+{
+	if (batchSize < 1)
+		batchSize = 1;
+
+	for (int i = 0; i < iterations; i += batchSize)
+	{
+		if (m_dispatch && m_dispatch->shouldAbort())
+			break;
+
+		simulate(plies, min(batchSize, iterations - i));
+
+		if (!pruneRace(byWin, z))
+			return false;
+	}
+
+	return true;
+}
+
+// the value moves are raced on, and how far off it may be
+static double raceMean(const SimmedMove &simmedMove, bool byWin)
+{
+	return byWin? simmedMove.wins.averagedValue() : simmedMove.calculateEquity();
+}
+
+static double raceError(const SimmedMove &simmedMove, bool byWin)
+{
+	const AveragedValue &value = byWin? simmedMove.wins : simmedMove.equity;
+	if (value.incorporatedValues() <= 1)
+		return HUGE_VAL;
+
+	return value.standardDeviation() / sqrt((double)value.incorporatedValues());
+}
+
+bool Simulator::pruneRace(bool byWin, double z)
+{
+	SimmedMoveList::iterator leader = m_simmedMoves.end();
+	const SimmedMoveList::iterator end = m_simmedMoves.end();
+	for (SimmedMoveList::iterator it = m_simmedMoves.begin(); it != end; ++it)
+		if ((*it).includeInSimulation() && (leader == end || raceMean(*it, byWin) > raceMean(*leader, byWin)))
+			leader = it;
+
+	if (leader == end)
+		return false;
+
+	const double leaderLowerBound = raceMean(*leader, byWin) - z * raceError(*leader, byWin);
+
+	bool isOpen = false;
+	for (SimmedMoveList::iterator it = m_simmedMoves.begin(); it != end; ++it)
+	{
+		if (it == leader || !(*it).includeInSimulation())
+			continue;
+
+		if (raceMean(*it, byWin) + z * raceError(*it, byWin) >= leaderLowerBound)
+			isOpen = true;
+		else if (!isConsideredMove((*it).move))
+			(*it).setIncludeInSimulation(false);
+	}
+
+	return isOpen;
+}
+
+void Simulator::setRandomSeed(uint64_t seed)
+{
+	m_hasRandomSeed = true;
+	m_randomSeed = seed;
+	m_nextStream.seed(seed);
+	m_nextStreamIndex = 0;
+}
+
+IterationStream Simulator::takeIterationStream()
+{
+	if (!m_hasRandomSeed)
+		setRandomSeed(DataManager::self()->randomNumber());
+
+	IterationStream ret(m_randomSeed, m_nextStreamIndex, m_nextStream);
+
+	m_nextStream.jump();
+	++m_nextStreamIndex;
+
+	return ret;
+}
 
-	const int startPlayerId = m_originalGame.currentPosition().currentPlayer().id();
-	const int numberOfPlayers = m_originalGame.currentPosition().players().size();
+void Simulator::replayIteration(int plies, uint64_t seed, int index, UVOStream &log) const
+{
+	DataManagerScope scope(m_dataManager);
+	RandomStreamScope streamScope;
+
+	const IterationStream stream(seed, index, RandomGenerator::substream(seed, index));
+	SimmedMoveList simmedMoves(blankSimmedMoves());
+	GamePosition iterationPosition;
+	Playout playout;
+
+	simulateIteration(iterationPosition, playout, simmedMoves, plies, stream, 0, &log);
+}
+
+SimmedMoveList Simulator::blankSimmedMoves() const
+{
+	SimmedMoveList ret;
+	for (const auto &it : m_simmedMoves)
+	{
+		SimmedMove blankSimmedMove(it.move);
+		blankSimmedMove.setIncludeInSimulation(it.includeInSimulation());
+		ret.push_back(blankSimmedMove);
+	}
+
+	return ret;
+}
+
+void Simulator::simulateInParallel(int plies, int iterations)
+{
+	if (isLogging() && !m_hasHeader)
+		writeLogHeader();
+
+	// streams are handed out in order on this thread so that which
+	// thread runs an iteration has no effect on its outcome
+	vector<IterationStream> streams;
+	for (int i = 0; i < iterations; ++i)
+		streams.push_back(takeIterationStream());
+
+	vector<SimmedMoveList> results(iterations, blankSimmedMoves());
+	vector<UVString> logs(isLogging()? iterations : 0);
+	vector<char> finished(iterations, false);
+
+	atomic<int> nextIteration(0);
+	atomic<bool> aborted(false);
+
+	DataManager *dataManager = DataManager::self();
+
+	// Only the calling thread talks to the dispatch, which
+	// need not be thread safe.
+	auto work = [&](bool ownsDispatch)
+	{
+		DataManagerScope scope(dataManager);
+		RandomStreamScope streamScope;
+
+		GamePosition iterationPosition;
+		Playout playout;
+
+		while (!aborted)
+		{
+			if (ownsDispatch && m_dispatch && m_dispatch->shouldAbort())
+			{
+				aborted = true;
+				break;
+			}
+
+			const int i = nextIteration++;
+			if (i >= iterations)
+				break;
+
+			if (isLogging())
+			{
+				UVOStringStream log;
+				simulateIteration(iterationPosition, playout, results[i], plies, streams[i], m_iterations + i + 1, &log);
+				logs[i] = log.str();
+			}
+			else
+				simulateIteration(iterationPosition, playout, results[i], plies, streams[i], m_iterations + i + 1, 0);
+
+			finished[i] = true;
+		}
+	};
+
+	vector<thread> threads;
+	for (int i = 1; i < m_threadCount && i < iterations; ++i)
+		threads.push_back(thread(work, false));
+
+	work(true);
+
+	for (auto &it : threads)
+		it.join();
+
+	// after an abort, keep only the unbroken run of finished
+	// iterations, which is what a one-thread run would have done
+	for (int i = 0; i < iterations && finished[i]; ++i)
+	{
+		++m_iterations;
+
+		SimmedMoveList::iterator simmedMoveIt = m_simmedMoves.begin();
+		for (SimmedMoveList::const_iterator resultIt = results[i].begin(); resultIt != results[i].end(); ++resultIt, ++simmedMoveIt)
+			if ((*resultIt).includeInSimulation())
+				(*simmedMoveIt).incorporateSimmedMove(*resultIt);
+
+		if (isLogging())
+			m_logfileStream << logs[i];
+	}
+}
+
+void Simulator::simulateIteration(GamePosition &iterationPosition, Playout &playout, SimmedMoveList &simmedMoves, int plies, const IterationStream &stream, int iterationIndex, UVOStream *log) const
+{
+	DataManager::self()->setThreadRandomGenerator(stream.generator);
+
+	// start from the original every time, as even the order of
+	// tiles in the bag would otherwise carry over between iterations
+	iterationPosition = m_originalGame.currentPosition();
+	randomizeOppoRacks(iterationPosition);
+	randomizeDrawingOrder(iterationPosition);
+
+	// every move is played out on iterationPosition itself and
+	// taken back afterwards
+	playout.start(&iterationPosition, m_originalGame.history());
+	GamePosition &simulatedPosition = playout.position();
+
+	const int startPlayerId = iterationPosition.currentPlayer().id();
+	const int numberOfPlayers = iterationPosition.players().size();
 
 	if (plies < 0)
 		plies = 1000;
@@ -251,17 +474,16 @@ void Simulator::simulate(int plies)
 	// also one-indexed
 	const int levels = (int)((plies - decimalTurns) / numberOfPlayers);
 
-	if (isLogging())
-	{
-		if (!m_hasHeader)
-			writeLogHeader();
+	UVString xmlIndent = m_xmlIndent;
 
-		m_logfileStream << m_xmlIndent << "<iteration index=\"" << m_iterations << "\">" << endl;
-		m_xmlIndent += MARK_UV('\t');
+	if (log)
+	{
+		(*log) << xmlIndent << "<iteration index=\"" << iterationIndex << "\" seed=\"" << stream.seed << "\" stream=\"" << stream.index << "\">" << endl;
+		xmlIndent += MARK_UV('\t');
 	}
 
-	SimmedMoveList::iterator moveEnd = m_simmedMoves.end();
-	for (SimmedMoveList::iterator moveIt = m_simmedMoves.begin(); moveIt != moveEnd; ++moveIt)
+	SimmedMoveList::iterator moveEnd = simmedMoves.end();
+	for (SimmedMoveList::iterator moveIt = simmedMoves.begin(); moveIt != moveEnd; ++moveIt)
 	{
 		if (!(*moveIt).includeInSimulation())
 			continue;
@@ -270,19 +492,20 @@ void Simulator::simulate(int plies)
 		UVcout << "simulating " << (*moveIt).move << ":" << endl;
 #endif
 
-		if (isLogging())
+		if (log)
 		{
-			m_logfileStream << m_xmlIndent << "<playahead>" << endl;
-			m_xmlIndent += MARK_UV('\t');
+			(*log) << xmlIndent << "<playahead>" << endl;
+			xmlIndent += MARK_UV('\t');
 		}
 
-		m_simulatedGame = m_originalGame;
+		playout.rewind();
 		double residual = 0;
+		double equity = 0;
 
 		(*moveIt).setNumberLevels(levels + 1);
 
 		int levelNumber = 1;
-		for (LevelList::iterator levelIt = (*moveIt).levels.begin(); levelNumber <= levels + 1 && levelIt != (*moveIt).levels.end() && !m_simulatedGame.currentPosition().gameOver(); ++levelIt, ++levelNumber)
+		for (LevelList::iterator levelIt = (*moveIt).levels.begin(); levelNumber <= levels + 1 && levelIt != (*moveIt).levels.end() && !simulatedPosition.gameOver(); ++levelIt, ++levelNumber)
 		{
 			const int decimal = levelNumber == levels + 1? decimalTurns : numberOfPlayers;
 			if (decimal == 0)
@@ -291,14 +514,14 @@ void Simulator::simulate(int plies)
 			(*levelIt).setNumberScores(decimal);
 
 			int playerNumber = 1;
-			for (PositionStatisticsList::iterator scoresIt = (*levelIt).statistics.begin(); scoresIt != (*levelIt).statistics.end() && !m_simulatedGame.currentPosition().gameOver(); ++scoresIt, ++playerNumber)
+			for (PositionStatisticsList::iterator scoresIt = (*levelIt).statistics.begin(); scoresIt != (*levelIt).statistics.end() && !simulatedPosition.gameOver(); ++scoresIt, ++playerNumber)
 			{
-				const int playerId = m_simulatedGame.currentPosition().currentPlayer().id();
+				const int playerId = simulatedPosition.currentPlayer().id();
 
-				if (isLogging())
+				if (log)
 				{
-					m_logfileStream << m_xmlIndent << "<ply index=\"" << (levelNumber - 1) * numberOfPlayers + playerNumber - 1 << "\">" << endl;
-					m_xmlIndent += MARK_UV('\t');
+					(*log) << xmlIndent << "<ply index=\"" << (levelNumber - 1) * numberOfPlayers + playerNumber - 1 << "\">" << endl;
+					xmlIndent += MARK_UV('\t');
 				}
 
 				Move move = Move::createNonmove();
@@ -308,25 +531,26 @@ void Simulator::simulate(int plies)
 				else if (m_ignoreOppos && playerId != startPlayerId)
 					move = Move::createPassMove();
 				else
-					move = m_simulatedGame.currentPosition().staticBestMove();
+					move = simulatedPosition.staticBestMove();
 
 				int deadwoodScore = 0;
-				if (m_simulatedGame.currentPosition().doesMoveEndGame(move))
+				if (simulatedPosition.doesMoveEndGame(move))
 				{
 					LetterString deadwood;
-					deadwoodScore = m_simulatedGame.currentPosition().deadwood(&deadwood);
+					deadwoodScore = simulatedPosition.deadwood(&deadwood);
 					// account for deadwood in this move rather than a separate
 					// UnusedTilesBonus move.
 					move.score += deadwoodScore;
 				}
 
 				(*scoresIt).score.incorporateValue(move.score);
+				equity += playerId == startPlayerId? move.score : -move.score;
 				(*scoresIt).bingos.incorporateValue(move.isBingo? 1.0 : 0.0);
 
-				if (isLogging())
+				if (log)
 				{
-					m_logfileStream << m_xmlIndent << m_simulatedGame.currentPosition().currentPlayer().rack().xml() << endl;
-					m_logfileStream << m_xmlIndent << move.xml() << endl;
+					(*log) << xmlIndent << simulatedPosition.currentPlayer().rack().xml() << endl;
+					(*log) << xmlIndent << move.xml() << endl;
 				}
 
 				// record future-looking residuals
@@ -341,20 +565,20 @@ void Simulator::simulate(int plies)
 
 				if (isFinalTurnForPlayerOfSimulation && !(m_ignoreOppos && playerId != startPlayerId))
 				{
-					double residualAddend = m_simulatedGame.currentPosition().calculatePlayerConsideration(move);
-					if (isLogging())
-						m_logfileStream << m_xmlIndent << "<pc value=\"" << residualAddend << "\" />" << endl;
+					double residualAddend = simulatedPosition.calculatePlayerConsideration(move);
+					if (log)
+						(*log) << xmlIndent << "<pc value=\"" << residualAddend << "\" />" << endl;
 
 					if (isVeryFinalTurnOfSimulation)
 					{
 						// experimental -- do shared resource considerations
 						// matter in a plied simulation?
 	
-						const double sharedResidual = m_simulatedGame.currentPosition().calculateSharedConsideration(move);
+						const double sharedResidual = simulatedPosition.calculateSharedConsideration(move);
 						residualAddend += sharedResidual;
 
-						if (isLogging() && sharedResidual != 0)
-							m_logfileStream << m_xmlIndent << "<sc value=\"" << sharedResidual << "\" />" << endl;
+						if (log && sharedResidual != 0)
+							(*log) << xmlIndent << "<sc value=\"" << sharedResidual << "\" />" << endl;
 					}
 
 					if (playerId == startPlayerId)
@@ -366,70 +590,74 @@ void Simulator::simulate(int plies)
 				// commiting the move will account for deadwood again
 				// so avoid double counting from above.
 				move.score -= deadwoodScore; 
-				m_simulatedGame.setCandidate(move);
+				playout.commitMove(move, !isVeryFinalTurnOfSimulation);
 
-				m_simulatedGame.commitCandidate(!isVeryFinalTurnOfSimulation);
-
-				if (isLogging())
+				if (log)
 				{
-					m_xmlIndent = m_xmlIndent.substr(0, m_xmlIndent.length() - 1);
-					m_logfileStream << m_xmlIndent << "</ply>" << endl;
+					xmlIndent = xmlIndent.substr(0, xmlIndent.length() - 1);
+					(*log) << xmlIndent << "</ply>" << endl;
 				}
 			}
 		}
 
 		(*moveIt).residual.incorporateValue(residual);
+		(*moveIt).equity.incorporateValue(equity + residual);
 
-		const int spread = m_simulatedGame.currentPosition().spread(startPlayerId);
+		const int spread = simulatedPosition.spread(startPlayerId);
 		(*moveIt).gameSpread.incorporateValue(spread);
 
-		if (m_simulatedGame.currentPosition().gameOver())
+		if (simulatedPosition.gameOver())
 		{
 			const float wins = spread > 0? 1 : spread == 0? 0.5F : 0;
 			(*moveIt).wins.incorporateValue(wins);
 
-			if (isLogging())
+			if (log)
 			{
-				m_logfileStream << m_xmlIndent << "<gameover win=\"" << wins << "\" />" << endl;
+				(*log) << xmlIndent << "<gameover win=\"" << wins << "\" />" << endl;
 			}
 		}
 		else
 		{
-			if (m_simulatedGame.currentPosition().currentPlayer().id() == startPlayerId)
-				(*moveIt).wins.incorporateValue(QUACKLE_STRATEGY_PARAMETERS->bogowin((int)(spread + residual), m_simulatedGame.currentPosition().bag().size() + QUACKLE_PARAMETERS->rackSize(), 0));
+			if (simulatedPosition.currentPlayer().id() == startPlayerId)
+				(*moveIt).wins.incorporateValue(QUACKLE_STRATEGY_PARAMETERS->bogowin((int)(spread + residual), simulatedPosition.bag().size() + QUACKLE_PARAMETERS->rackSize(), 0));
 			else
-				(*moveIt).wins.incorporateValue(1.0 - QUACKLE_STRATEGY_PARAMETERS->bogowin((int)(-spread - residual), m_simulatedGame.currentPosition().bag().size() + QUACKLE_PARAMETERS->rackSize(), 0));
+				(*moveIt).wins.incorporateValue(1.0 - QUACKLE_STRATEGY_PARAMETERS->bogowin((int)(-spread - residual), simulatedPosition.bag().size() + QUACKLE_PARAMETERS->rackSize(), 0));
 		}	
 		
 
-		if (isLogging())
+		if (log)
 		{
-			m_xmlIndent = m_xmlIndent.substr(0, m_xmlIndent.length() - 1);
-			m_logfileStream << m_xmlIndent << "</playahead>" << endl;
+			xmlIndent = xmlIndent.substr(0, xmlIndent.length() - 1);
+			(*log) << xmlIndent << "</playahead>" << endl;
 		}
 	}
 
-	if (isLogging())
+	if (log)
 	{
-		m_xmlIndent = m_xmlIndent.substr(0, m_xmlIndent.length() - 1);
-		m_logfileStream << m_xmlIndent << "</iteration>" << endl;
+		xmlIndent = xmlIndent.substr(0, xmlIndent.length() - 1);
+		(*log) << xmlIndent << "</iteration>" << endl;
 	}
 }
 
 void Simulator::randomizeOppoRacks()
+{
+	randomizeOppoRacks(m_originalGame.currentPosition());
+}
+
+void Simulator::randomizeOppoRacks(GamePosition &position) const
 {
 #ifdef DEBUG_SIM
 	UVcout << "RANDOMIZE OPPO RACKS " << endl;
 #endif
 
-	m_originalGame.currentPosition().ensureProperBag();
+	position.ensureProperBag();
 
-	Bag bag(m_originalGame.currentPosition().unseenBag());
+	Bag bag(position.unseenBag());
 
-	const PlayerList::const_iterator end = m_originalGame.currentPosition().players().end();
-	for (PlayerList::const_iterator it = m_originalGame.currentPosition().players().begin(); it != end; ++it)
+	const PlayerList::const_iterator end = position.players().end();
+	for (PlayerList::const_iterator it = position.players().begin(); it != end; ++it)
 	{
-		if (((*it) == m_originalGame.currentPosition().currentPlayer()))
+		if (((*it) == position.currentPlayer()))
 			continue;
 
 		// TODO -- some kind of inference engine can be inserted here
@@ -440,14 +668,14 @@ void Simulator::randomizeOppoRacks()
 		bag.removeLetters(rack.tiles());
 		bag.refill(rack);
 
-		m_originalGame.currentPosition().setPlayerRack((*it).id(), rack, /* adjust bag */ true);
+		position.setPlayerRack((*it).id(), rack, /* adjust bag */ true);
 	}
 
 #ifdef DEBUG_SIM
 	UVcout << "RANDOMIZE OPPO RACKS DONE" << endl;
 #endif
 
-	m_originalGame.currentPosition().ensureProperBag();
+	position.ensureProperBag();
 }
 
 void Simulator::setPartialOppoRack(const Rack &rack)
@@ -457,7 +685,12 @@ void Simulator::setPartialOppoRack(const Rack &rack)
 
 void Simulator::randomizeDrawingOrder()
 {
-	m_originalGame.currentPosition().setDrawingOrder(m_originalGame.currentPosition().bag().someShuffledTiles());
+	randomizeDrawingOrder(m_originalGame.currentPosition());
+}
+
+void Simulator::randomizeDrawingOrder(GamePosition &position) const
+{
+	position.setDrawingOrder(position.bag().someShuffledTiles());
 }
 
 MoveList Simulator::moves(bool prune, bool byWin) const
@@ -574,6 +807,21 @@ void SimmedMove::setNumberLevels(unsigned int number)
 void SimmedMove::clear()
 {
 	levels.clear();
+	equity.clear();
+}
+
+void SimmedMove::incorporateSimmedMove(const SimmedMove &other)
+{
+	setNumberLevels(other.levels.size());
+
+	LevelList::iterator levelIt = levels.begin();
+	for (LevelList::const_iterator otherIt = other.levels.begin(); otherIt != other.levels.end(); ++otherIt, ++levelIt)
+		(*levelIt).incorporateLevel(*otherIt);
+
+	residual.incorporateAveragedValue(other.residual);
+	gameSpread.incorporateAveragedValue(other.gameSpread);
+	wins.incorporateAveragedValue(other.wins);
+	equity.incorporateAveragedValue(other.equity);
 }
 
 PositionStatistics SimmedMove::getPositionStatistics(int level, int playerIndex) const
@@ -594,6 +842,12 @@ AveragedValue PositionStatistics::getStatistic(StatisticType type) const
 	return AveragedValue();
 }
 
+void PositionStatistics::incorporatePositionStatistics(const PositionStatistics &other)
+{
+	score.incorporateAveragedValue(other.score);
+	bingos.incorporateAveragedValue(other.bingos);
+}
+
 ////////////
 
 void Level::setNumberScores(unsigned int number)
@@ -602,6 +856,15 @@ void Level::setNumberScores(unsigned int number)
 		statistics.push_back(PositionStatistics());
 }
 
+void Level::incorporateLevel(const Level &other)
+{
+	setNumberScores(other.statistics.size());
+
+	PositionStatisticsList::iterator statisticsIt = statistics.begin();
+	for (PositionStatisticsList::const_iterator otherIt = other.statistics.begin(); otherIt != other.statistics.end(); ++otherIt, ++statisticsIt)
+		(*statisticsIt).incorporatePositionStatistics(*otherIt);
+}
+
 //////////
 
 UVOStream& operator<<(UVOStream &o, const Quackle::AveragedValue &value)
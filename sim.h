@@ -23,11 +23,13 @@
 
 #include "alphabetparameters.h"
 #include "game.h"
+#include "randomgenerator.h"
 
 namespace Quackle
 {
 
 class ComputerDispatch;
+class DataManager;
 
 struct AveragedValue
 {
@@ -39,6 +41,10 @@ struct AveragedValue
 
     void incorporateValue(double newValue);
 
+    // add sums and counts of other to ours, as if
+    // other's values had been incorporated one by one
+    void incorporateAveragedValue(const AveragedValue &other);
+
     // zero everything
     void clear();
 
@@ -69,6 +75,13 @@ inline void AveragedValue::incorporateValue(double newValue)
     ++m_incorporatedValues;
 }
 
+inline void AveragedValue::incorporateAveragedValue(const AveragedValue &other)
+{
+    m_valueSum += other.m_valueSum;
+    m_squaredValueSum += other.m_squaredValueSum;
+    m_incorporatedValues += other.m_incorporatedValues;
+}
+
 inline long double AveragedValue::valueSum() const
 {
     return m_valueSum;
@@ -99,6 +112,8 @@ struct PositionStatistics
     enum StatisticType { StatisticScore, StatisticBingos };
     AveragedValue getStatistic(StatisticType type) const;
 
+    void incorporatePositionStatistics(const PositionStatistics &other);
+
     AveragedValue score;
     AveragedValue bingos;
 };
@@ -110,6 +125,9 @@ struct Level
     // expand the scores list to be at least number long
     void setNumberScores(unsigned int number);
 
+    // expand to other's size and incorporate its statistics
+    void incorporateLevel(const Level &other);
+
     PositionStatisticsList statistics;
 };
 
@@ -133,6 +151,10 @@ struct SimmedMove
     // clear all level values
     void clear();
 
+    // incorporate levels, residual, spread and wins of other,
+    // which must be a simulation of the same move
+    void incorporateSimmedMove(const SimmedMove &other);
+
     bool includeInSimulation() const;
     void setIncludeInSimulation(bool includeInSimulation);
 
@@ -142,6 +164,10 @@ struct SimmedMove
     AveragedValue gameSpread;
     AveragedValue wins;
 
+    // our scores - their scores + residual of each iteration, whose
+    // spread tells how far calculateEquity() can be trusted
+    AveragedValue equity;
+
     PositionStatistics getPositionStatistics(int level, int playerIndex) const;
 
 private:
@@ -160,6 +186,16 @@ inline void SimmedMove::setIncludeInSimulation(bool includeInSimulation)
 
 typedef vector<SimmedMove> SimmedMoveList;
 
+// The random stream an iteration draws from: the index-th jump from seed.
+struct IterationStream
+{
+    IterationStream(uint64_t _seed, int _index, const RandomGenerator &_generator) : seed(_seed), index(_index), generator(_generator) { }
+
+    uint64_t seed;
+    int index;
+    RandomGenerator generator;
+};
+
 class Simulator
 {
 public:
@@ -186,6 +222,12 @@ public:
     void setLogfile(const string &logfile, bool append = true);
     string logfile() const;
 
+    // Data manager that simulation runs against, in this thread and
+    // in its worker threads. If unset, the one current on the
+    // calling thread is used.
+    void setDataManager(DataManager *dataManager);
+    DataManager *dataManager() const;
+
     // Will honor dispatch->shouldAbort() but won't signal
     // any doneness for now.
     void setDispatch(ComputerDispatch *dispatch);
@@ -235,6 +277,36 @@ public:
     // simulate one iteration
     void simulate(int plies);
 
+    // Simulates like simulate(plies, iterations), but races the
+    // included moves: after every batchSize iterations, each move
+    // whose equity (win percentage if byWin) is clearly below the
+    // leader's stops being included in the simulation. A move is
+    // clearly below when its mean plus z standard errors is under
+    // the leader's mean minus z standard errors. Considered moves are
+    // never dropped. Stops early and returns false once every other
+    // move is clearly below the leader; otherwise returns true.
+    bool race(int plies, int iterations, bool byWin = false, int batchSize = 20, double z = 1.96);
+
+    // Number of threads that simulate(plies, iterations) spreads
+    // its iterations over. Each thread plays out on its own copy
+    // of the game, and every iteration draws from its own random
+    // stream handed out up front, so results are identical to a
+    // one-thread run from the same seed. Defaults to 1.
+    void setThreadCount(int threadCount);
+    int threadCount() const;
+
+    // Seed that iteration streams are jumped from. Iteration streams
+    // start over at index zero when this is set. If it is never set,
+    // a seed is drawn from the data manager at the first iteration.
+    // Seed and stream index of each iteration are logged.
+    void setRandomSeed(uint64_t seed);
+    uint64_t randomSeed() const;
+
+    // Plays the iteration that drew from stream index of seed again,
+    // writing its xml to log without incorporating its results, to
+    // look into an outlying iteration found in the log.
+    void replayIteration(int plies, uint64_t seed, int index, UVOStream &log) const;
+
     // Set oppo's rack to some partially-known tiles.
     // Set this to an empty rack if no tiles are known, so
     // that all tiles are chosen randomly each iteration.
@@ -273,6 +345,31 @@ protected:
     void writeLogHeader();
     void writeLogFooter();
 
+    void randomizeOppoRacks(GamePosition &position) const;
+    void randomizeDrawingOrder(GamePosition &position) const;
+
+    // drops included moves clearly below the leader, as race() does;
+    // returns whether any move is not clearly below it
+    bool pruneRace(bool byWin, double z);
+
+    // hands out the next iteration stream
+    IterationStream takeIterationStream();
+
+    // Runs one iteration with the calling thread drawing from stream.
+    // iterationPosition is set to the original position with randomized
+    // oppo racks and drawing order, then each included move of simmedMoves
+    // is played out on it with playout, its results incorporated, and
+    // taken back again.
+    // Xml goes to log if it is nonzero.
+    void simulateIteration(GamePosition &iterationPosition, Playout &playout, SimmedMoveList &simmedMoves, int plies, const IterationStream &stream, int iterationIndex, UVOStream *log) const;
+
+    // blank statistics for the moves of m_simmedMoves
+    SimmedMoveList blankSimmedMoves() const;
+
+    // splits iterations over m_threadCount threads and incorporates
+    // their results in iteration order
+    void simulateInParallel(int plies, int iterations);
+
     UVOFStream m_logfileStream;
     string m_logfile;
     bool m_logfileIsOpen;
@@ -282,8 +379,9 @@ protected:
     Rack m_partialOppoRack;
 
     Game m_originalGame;
-    Game m_simulatedGame;
+    Playout m_playout;
     ComputerDispatch *m_dispatch;
+    DataManager *m_dataManager;
 
     SimmedMoveList m_simmedMoves;
 
@@ -292,6 +390,12 @@ protected:
 
     int m_iterations;
     bool m_ignoreOppos;
+    int m_threadCount;
+
+    bool m_hasRandomSeed;
+    uint64_t m_randomSeed;
+    RandomGenerator m_nextStream;
+    int m_nextStreamIndex;
 };
 
 inline GamePosition &Simulator::currentPosition()
@@ -314,6 +418,16 @@ inline ComputerDispatch *Simulator::dispatch() const
 	return m_dispatch;
 }
 
+inline void Simulator::setDataManager(DataManager *dataManager)
+{
+	m_dataManager = dataManager;
+}
+
+inline DataManager *Simulator::dataManager() const
+{
+	return m_dataManager;
+}
+
 inline string Simulator::logfile() const
 {
 	return m_logfile;
@@ -349,6 +463,21 @@ inline bool Simulator::ignoreOppos() const
 	return m_ignoreOppos;
 }
 
+inline void Simulator::setThreadCount(int threadCount)
+{
+	m_threadCount = threadCount < 1? 1 : threadCount;
+}
+
+inline int Simulator::threadCount() const
+{
+	return m_threadCount;
+}
+
+inline uint64_t Simulator::randomSeed() const
+{
+	return m_randomSeed;
+}
+
 inline int Simulator::iterations() const
 {
 	return m_iterations;
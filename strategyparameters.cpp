@@ -16,6 +16,7 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
 
@@ -26,17 +27,24 @@
 
 using namespace Quackle;
 
+static atomic<unsigned int> lastGeneration(0);
+
 StrategyParameters::StrategyParameters()
-	: m_hasSyn2(false)
+	: m_superleaveTableLength(0)
+	, m_superleaveSymbols(0)
+	, m_hasSyn2(false)
 	, m_hasWorths(false)
 	, m_hasVcPlace(false)
 	, m_hasBogowin(false)
 	, m_hasSuperleaves(false)
 {
+	m_generation = ++lastGeneration;
 }
 
 void StrategyParameters::initialize(const string &lexicon)
 {
+	m_generation = ++lastGeneration;
+
 	m_hasSyn2 = loadSyn2(DataManager::self()->findDataFile("strategy", lexicon, "syn2"));
 	m_hasWorths = loadWorths(DataManager::self()->findDataFile("strategy", lexicon, "worths"));
 	m_hasVcPlace = loadVcPlace(DataManager::self()->findDataFile("strategy", lexicon, "vcplace"));
@@ -210,6 +218,8 @@ bool StrategyParameters::loadVcPlace(const string &filename)
 bool StrategyParameters::loadSuperleaves(const string &filename)
 {
 	m_superleaves.clear();
+	m_superleaveTable.clear();
+	m_superleaveTableLength = 0;
 
 	ifstream file(filename.c_str(), ios::in | ios::binary);
 
@@ -243,5 +253,57 @@ bool StrategyParameters::loadSuperleaves(const string &filename)
 	}
 	
 	file.close();
+
+	int maximumLength = 0;
+	for (const auto &it : m_superleaves)
+		maximumLength = max(maximumLength, (int)it.first.length());
+
+	buildSuperleaveTable(maximumLength);
 	return true;	
 }
+
+void StrategyParameters::buildSuperleaveTable(int maximumLength)
+{
+	m_superleaveSymbols = QUACKLE_ALPHABET_PARAMETERS->lastLetter() - QUACKLE_FIRST_LETTER + 2;
+
+	const int rows = m_superleaveSymbols + maximumLength;
+	if (maximumLength == 0 || maximumLength > QUACKLE_MAXIMUM_BOARD_SIZE || rows > QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE + QUACKLE_MAXIMUM_BOARD_SIZE)
+		return;
+
+	// binomials as far as we need them, capped so as not to overflow
+	const long long cap = m_maximumSuperleaveTableSize + 1;
+	for (int n = 0; n < rows; ++n)
+	{
+		for (int k = 0; k <= maximumLength; ++k)
+		{
+			long long binomial = k == 0? 1 : n == 0? 0 : (long long)m_binomials[n - 1][k - 1] + m_binomials[n - 1][k];
+			m_binomials[n][k] = (int)min(binomial, cap);
+		}
+	}
+
+	long long size = 0;
+	for (int length = 1; length <= maximumLength; ++length)
+	{
+		m_superleaveOffsets[length] = (int)size;
+		size += m_binomials[m_superleaveSymbols + length - 1][length];
+		if (size > m_maximumSuperleaveTableSize)
+			return;
+	}
+
+	m_superleaveTable.assign(size, 0);
+
+	for (const auto &it : m_superleaves)
+	{
+		const int index = superleaveIndex(String::alphabetize(it.first));
+		if (index < 0)
+		{
+			// a leave the table can't hold; keep using the map
+			m_superleaveTable.clear();
+			return;
+		}
+		m_superleaveTable[index] = it.second;
+	}
+
+	m_superleaveTableLength = maximumLength;
+	m_superleaves.clear();
+}
@@ -20,6 +20,7 @@
 #define QUACKLE_STRATEGYPARAMETERS_H
 
 #include <map>
+#include <vector>
 #include "alphabetparameters.h"
 
 namespace Quackle
@@ -42,7 +43,13 @@ public:
 	double tileWorth(Letter letter) const;
 	double vcPlace(int start, int length, int consbits);
 	double bogowin(int lead, int unseen, int blanks);
-	double superleave(LetterString leave);
+
+	// value of an alphabetized leave, or zero if it has none
+	double superleave(const LetterString &leave) const;
+
+	// changes whenever initialize is called on any instance, so that
+	// caches of values derived from strategy can tell when to refresh
+	unsigned int generation() const;
 	
 protected:
 	bool loadSyn2(const string &filename);
@@ -53,6 +60,14 @@ protected:
 	
 	int mapLetter(Letter letter) const;
 
+	// Superleaves are kept in a flat table indexed by the rank of the
+	// leave among all multisets of its length over blank plus the
+	// alphabet, which costs one array load per lookup. Alphabets too
+	// big for such a table fall back on the map.
+	void buildSuperleaveTable(int maximumLength);
+	int superleaveIndex(const LetterString &leave) const;
+	static const int m_maximumSuperleaveTableSize = 1 << 24;
+
 	double m_syn2[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE][QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE];
 	double m_tileWorths[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE];
 	double m_vcPlace[QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE][128];
@@ -62,6 +77,12 @@ protected:
 	double m_bogowin[m_bogowinArrayWidth][m_bogowinArrayHeight];
 	typedef map<LetterString, double> SuperLeavesMap;
 	SuperLeavesMap m_superleaves;
+	vector<float> m_superleaveTable;
+	int m_superleaveTableLength;
+	int m_superleaveSymbols;
+	int m_superleaveOffsets[QUACKLE_MAXIMUM_BOARD_SIZE + 1];
+	int m_binomials[QUACKLE_FIRST_LETTER + QUACKLE_MAXIMUM_ALPHABET_SIZE + QUACKLE_MAXIMUM_BOARD_SIZE][QUACKLE_MAXIMUM_BOARD_SIZE + 1];
+	unsigned int m_generation;
 	bool m_hasSyn2;
 	bool m_hasWorths;
 	bool m_hasVcPlace;
@@ -137,11 +158,45 @@ inline double StrategyParameters::bogowin(int lead, int unseen, int /* blanks */
 	return m_bogowin[lead + 300][unseen];
 }
 
-inline double StrategyParameters::superleave(LetterString leave)
+inline unsigned int StrategyParameters::generation() const
 {
-	if (leave.length() == 0)
+	return m_generation;
+}
+
+inline int StrategyParameters::superleaveIndex(const LetterString &leave) const
+{
+	// colex rank of the combination that the sorted multiset maps to
+	const int length = leave.length();
+	int index = m_superleaveOffsets[length];
+	for (int i = 0; i < length; ++i)
+	{
+		const int symbol = leave[i] == QUACKLE_BLANK_MARK? 0 : leave[i] - QUACKLE_FIRST_LETTER + 1;
+		if (symbol < 0 || symbol >= m_superleaveSymbols)
+			return -1;
+		index += m_binomials[symbol + i][i + 1];
+	}
+
+	return index;
+}
+
+inline double StrategyParameters::superleave(const LetterString &leave) const
+{
+	const int length = leave.length();
+	if (length == 0)
 		return 0.0;
-	return m_superleaves[leave];
+
+	if (!m_superleaveTable.empty())
+	{
+		if (length > m_superleaveTableLength)
+			return 0.0;
+
+		const int index = superleaveIndex(leave);
+		return index < 0? 0.0 : m_superleaveTable[index];
+	}
+
+	// lookups must not insert; simulation threads share this map
+	SuperLeavesMap::const_iterator it = m_superleaves.find(leave);
+	return it == m_superleaves.end()? 0.0 : it->second;
 }
 
 }
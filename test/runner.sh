@@ -1,14 +1,13 @@
 #!/bin/bash
-#This is for running multiple game simulations in manageable chunks.
-#Just specify the number of reps per simulation (50k takes 1h on a i5
-#processor) and the random seed for reproducibility
+#This is for running a long playability simulation on every core.
+#Games are written to output/playability-seed$seed in shards; if the
+#run is interrupted, running it again with the same arguments picks up
+#from the last finished shard. Specify the number of games and the
+#random seed for reproducibility
 #./runner 50000 1
 
 reps=$1
-i=$2
+seed=$2
 
-while true
-do
-    ./test --alphabet=polish --lexicon=osps --mode=playability --repetitions=$reps --seed=$i >> output/playability-reps$reps-seed$i
-    ((i++))
-done
+mkdir -p output
+./test --alphabet=polish --lexicon=osps --mode=tournament --playability --threads=$(nproc) --repetitions=$reps --seed=$seed --output=output/playability-seed$seed
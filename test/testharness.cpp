@@ -20,21 +20,30 @@
 
 #include <QtCore>
 
+#include <atomic>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <algorithm>
+#include <mutex>
+#include <thread>
 
 #include <bogowinplayer.h>
 #include <computerplayercollection.h>
 #include <resolvent.h>
 #include <datamanager.h>
 #include <endgameplayer.h>
+#include <endgamesolver.h>
 #include <game.h>
 #include <gameparameters.h>
 #include <lexiconparameters.h>
 #include <strategyparameters.h>
 #include <enumerator.h>
+#include <generator.h>
+#include <randomgenerator.h>
 #include <reporter.h>
+#include <resultcache.h>
+#include <sim.h>
 
 #include <quackleio/dictimplementation.h>
 #include <quackleio/flexiblealphabet.h>
@@ -88,6 +97,14 @@ const char *usage =
 "       'randomracks' spit out random racks (forever?).\n"
 "       'leavecalc' spit out roughish values of leaves in 'leaves' file.\n"
 "       'anagram' anagrams letters supplied in --letters.\n"
+"       'commitbench' times committing moves to the board, per ply.\n"
+"       'movegenbench' times finding the best move and cross sets.\n"
+"       'endgamecheck' compares the endgame solver with brute force on\n"
+"                      small endgames of static games.\n"
+"       'playoutcheck' compares playing out candidates in place with\n"
+"                      playing them out on copies of the game.\n"
+"       'tournament' plays selfplay games on many threads, in resumable\n"
+"                    shards, and sums up wins and spread.\n"
 "--position=game.gcg; this option can be repeated to specify positions\n"
 "                     to test.\n"
 "--lexicon=; sets the lexicon (default 'twl06').\n"
@@ -97,7 +114,11 @@ const char *usage =
 "--letters; letters to anagram.\n"
 "--build; when mode is anagram, do not require that all letters be used.\n"
 "--quiet; print nothing during selfplay games (default false).\n"
-"--repetitions=integer; the number of games for selfplay (default 1000).\n";
+"--repetitions=integer; the number of games for selfplay (default 1000).\n"
+"--threads=integer; threads for tournament (default one per core).\n"
+"--shard=integer; games per tournament shard file (default 100).\n"
+"--output=dir; directory of tournament shards (default 'tournament').\n"
+"--playability; play tournament games for playability output.\n";
 
 void TestHarness::executeFromArguments()
 {
@@ -112,6 +133,10 @@ void TestHarness::executeFromArguments()
 	QString letters;
 	bool help;
 	bool report;
+	bool playability;
+	QString threadsString;
+	QString shardString;
+	QString output;
 	unsigned int seed = numeric_limits<unsigned int>::max();
 	unsigned int reps = 1000;
 
@@ -123,9 +148,13 @@ void TestHarness::executeFromArguments()
 	opts.addOption('s', "seed", &seedString);
 	opts.addOption('r', "repetitions", &repString);
 	opts.addOption('t', "letters", &letters);
+	opts.addOption('j', "threads", &threadsString);
+	opts.addOption('k', "shard", &shardString);
+	opts.addOption('o', "output", &output);
 	opts.addRepeatableOption("position", &m_positions);
 
 	opts.addSwitch("report", &report);
+	opts.addSwitch("playability", &playability);
 	opts.addSwitch("build", &build);
 	opts.addSwitch("quiet", &m_quiet);
 	opts.addSwitch("help", &help);
@@ -153,6 +182,8 @@ void TestHarness::executeFromArguments()
 	        seed = seedString.toUInt();
 	if (!repString.isNull())
 	        reps = repString.toUInt();
+	if (output.isNull())
+		output = "tournament";
 
 
 	m_computerPlayerToTest = checkPlayerName(computer);
@@ -184,6 +215,16 @@ void TestHarness::executeFromArguments()
 		wordDump();
 	else if (mode == "bingos")
 		bingos();
+	else if (mode == "commitbench")
+		commitBenchmark(seed, reps);
+	else if (mode == "movegenbench")
+		movegenBenchmark(seed, reps);
+	else if (mode == "endgamecheck")
+		endgameCheck(seed, reps);
+	else if (mode == "playoutcheck")
+		playoutCheck(seed, reps);
+	else if (mode == "tournament")
+		tournament(seed, reps, threadsString.toInt(), shardString.isNull()? 100 : shardString.toUInt(), output, playability);
 }
 
 void TestHarness::startUp()
@@ -656,6 +697,108 @@ void TestHarness::testReport(bool html)
 	}
 }
 
+// Writes the best plays of moves, and the difference between them and
+// the next best play using other letters, for computing playability.
+static void writePlayability(const GamePosition &position, const MoveList &moves, int turn, UVOStream &out)
+{
+	// alkamid's mod: output the best move and the difference between it and the next best that uses different letters (for calculating playability)
+	//TODO: exchange moves get written even if they shouldn't
+
+	// store tiles used in the top move
+	//Rack used = moves.front().usedTiles();
+	Rack tempUsed;
+	double diff = 0.0;
+	std::vector<Quackle::LetterString> bestMoves;
+	std::vector<Quackle::LetterString> hooks;
+
+	// only consider non-exchange moves (we're not interested what are the best racks to exchange)
+	if (moves.front().action != Move::Exchange) {
+
+	    // start from the top of the best moves list 
+	    for (MoveList::const_iterator it = moves.begin(); it != moves.end(); ++it) {
+
+		
+		// is there a difference in equity between this move and the top move?
+		diff = moves.front().equity - (*it).equity;
+
+		// used for checking if move is already in bestMoves
+		int found = 0;
+		int found_hook = 0;
+		int add_hooks = 1;
+
+		// if not:
+		if (diff == 0) {
+
+		    // if move is an exchange, write out whatever moves we have so far and don't look further down the list of moves 
+		    if ((*it).action == Move::Exchange) {
+			break;
+		    }
+
+		    // if the difference in equity is 0 and this move doesn't exist in bestMoves, add it
+		    for (uint j =0; j< bestMoves.size(); j++) {
+					    
+			if (bestMoves[j] == (*it).wordTiles()) {
+			    found = 1;
+			    break;
+			}
+		    }
+		    if (found == 0) {
+			if (turn != 0) {
+			    add_hooks = 1;
+			}
+			
+			bestMoves.push_back((*it).wordTiles());
+		    }
+		}
+
+		// when diff != 0, we are only interested if the next word is one that we already saved but in a different position
+		// if so, we'll go further down the list of moves
+		else {
+  
+		    for (uint j =0; j< bestMoves.size(); j++) {
+			if (bestMoves[j] == (*it).wordTiles()) {
+			    found = 1;
+			    add_hooks = 1;
+			    break;
+			}
+		    }
+		    		    
+		    if (found == 0) {
+			break;
+		    }
+		}
+		// adding hooks, for analysing hook playability. All hooked words are preceded by # in the output file
+		if (add_hooks == 1) {
+		    MoveList allwords = position.board().allWordsFormedBy((*it));
+							
+		    for (uint k = 1; k < allwords.size(); k++) {
+			found_hook = 0;
+			for (uint l = 0; l < hooks.size(); l++) {
+			    
+			    if (allwords[k].prettyTiles() == hooks[l]) {
+				found_hook = 1;
+				break;
+			    }
+			}
+			if (found_hook == 0) {
+			    hooks.push_back(allwords[k].prettyTiles());
+			}
+		    }
+		}
+		
+	    }
+	    for (uint j = 0; j < hooks.size(); j++) {
+		out << '#' << QUACKLE_ALPHABET_PARAMETERS->userVisible(hooks[j]) << ' ' << diff/bestMoves.size() << endl;
+	    }
+	    for (uint j = 0; j < bestMoves.size(); j++) {
+		    
+		out << QUACKLE_ALPHABET_PARAMETERS->userVisible(bestMoves[j]) << " " << diff/bestMoves.size() << endl;
+	    }
+	      
+	}
+	// end: alkamid's mod
+}
+
 void TestHarness::selfPlayGames(unsigned int seed, unsigned int reps, bool reports, bool playability)
 {
 	if (seed != numeric_limits<unsigned int>::max()) {
@@ -718,104 +861,9 @@ void TestHarness::selfPlayGame(unsigned int gameNumber, bool reports, bool playa
             if (playability) {
                 game.currentPosition().kibitz(100);
                 Quackle::MoveList moves = game.currentPosition().moves();
-		
-	        // alkamid's mod: output the best move and the difference between it and the next best that uses different letters (for calculating playability)
-		//TODO: exchange moves get written even if they shouldn't
-
-		// store tiles used in the top move
-		//Rack used = moves.front().usedTiles();
-		Rack tempUsed;
-		double diff = 0.0;
-		std::vector<Quackle::LetterString> bestMoves;
-		std::vector<Quackle::LetterString> hooks;
-
-		// only consider non-exchange moves (we're not interested what are the best racks to exchange)
-		if (moves.front().action != Move::Exchange) {
-
-		    // start from the top of the best moves list 
-		    for (MoveList::iterator it = moves.begin(); it != moves.end(); ++it) {
-
-			
-			// is there a difference in equity between this move and the top move?
-			diff = moves.front().equity - (*it).equity;
 
-			// used for checking if move is already in bestMoves
-			int found = 0;
-			int found_hook = 0;
-			int add_hooks = 1;
-
-			// if not:
-			if (diff == 0) {
-
-			    // if move is an exchange, write out whatever moves we have so far and don't look further down the list of moves 
-			    if ((*it).action == Move::Exchange) {
-				break;
-			    }
-
-			    // if the difference in equity is 0 and this move doesn't exist in bestMoves, add it
-			    for (uint j =0; j< bestMoves.size(); j++) {
-						    
-				if (bestMoves[j] == (*it).wordTiles()) {
-				    found = 1;
-				    break;
-				}
-			    }
-			    if (found == 0) {
-				if (i != 0) {
-				    add_hooks = 1;
-				}
-				
-				bestMoves.push_back((*it).wordTiles());
-			    }
-			}
+                writePlayability(game.currentPosition(), moves, i, UVcout);
 
-			// when diff != 0, we are only interested if the next word is one that we already saved but in a different position
-			// if so, we'll go further down the list of moves
-			else {
-  
-			    for (uint j =0; j< bestMoves.size(); j++) {
-				if (bestMoves[j] == (*it).wordTiles()) {
-				    found = 1;
-				    add_hooks = 1;
-				    break;
-				}
-			    }
-			    		    
-			    if (found == 0) {
-				break;
-			    }
-			}
-			// adding hooks, for analysing hook playability. All hooked words are preceded by # in the output file
-			if (add_hooks == 1) {
-			    MoveList allwords = game.currentPosition().board().allWordsFormedBy((*it));
-								
-			    for (uint k = 1; k < allwords.size(); k++) {
-				found_hook = 0;
-				for (uint l = 0; l < hooks.size(); l++) {
-				    
-				    if (allwords[k].prettyTiles() == hooks[l]) {
-					found_hook = 1;
-					break;
-				    }
-				}
-				if (found_hook == 0) {
-				    hooks.push_back(allwords[k].prettyTiles());
-				}
-			    }
-			}
-			
-		    }
-		    for (uint j = 0; j < hooks.size(); j++) {
-			UVcout << '#' << QUACKLE_ALPHABET_PARAMETERS->userVisible(hooks[j]) << ' ' << diff/bestMoves.size() << endl;
-		    }
-		    for (uint j = 0; j < bestMoves.size(); j++) {
-			    
-			UVcout << QUACKLE_ALPHABET_PARAMETERS->userVisible(bestMoves[j]) << " " << diff/bestMoves.size() << endl;
-		    }
-	      
-		}
-		// end: alkamid's mod
-                
                 game.commitMove(moves.front());
             } else {
                 Quackle::Move compMove(game.haveComputerPlay());
@@ -874,6 +922,256 @@ void TestHarness::selfPlayGame(unsigned int gameNumber, bool reports, bool playa
 	outFileReport.close();
 }
 
+// The random stream game index of a tournament off seed draws from.
+static RandomGenerator tournamentStream(unsigned int seed, unsigned int index)
+{
+	return RandomGenerator((static_cast<uint64_t>(seed) << 32) | index);
+}
+
+void TestHarness::playTournamentGame(ComputerPlayer *playerA, ComputerPlayer *playerB, unsigned int seed, unsigned int index, bool playability, UVOStream &out)
+{
+	RandomStreamScope streamScope;
+	DataManager::self()->setThreadRandomGenerator(tournamentStream(seed, index));
+
+	Quackle::Game game;
+
+	Quackle::Player compyA(playerA->name() + MARK_UV(" A"), Quackle::Player::ComputerPlayerType, 0);
+	compyA.setAbbreviatedName(MARK_UV("A"));
+	compyA.setComputerPlayer(playerA);
+
+	Quackle::Player compyB(playerB->name() + MARK_UV(" B"), Quackle::Player::ComputerPlayerType, 1);
+	compyB.setAbbreviatedName(MARK_UV("B"));
+	compyB.setComputerPlayer(playerB);
+
+	// players take turns going first
+	Quackle::PlayerList players;
+	players.push_back(index % 2? compyB : compyA);
+	players.push_back(index % 2? compyA : compyB);
+
+	game.setPlayers(players);
+	game.associateKnownComputerPlayers();
+	game.addPosition();
+
+	const int playahead = 50;
+	int turn;
+	for (turn = 0; turn < playahead && !game.currentPosition().gameOver(); ++turn)
+	{
+		if (playability)
+		{
+			game.currentPosition().kibitz(100);
+			const Quackle::MoveList moves = game.currentPosition().moves();
+			writePlayability(game.currentPosition(), moves, turn, out);
+			game.commitMove(moves.front());
+		}
+		else
+			game.haveComputerPlay();
+	}
+
+	const PlayerList scores = game.currentPosition().gameOver()? game.currentPosition().endgameAdjustedScores() : game.currentPosition().players();
+	int scoreA = 0;
+	int scoreB = 0;
+	for (PlayerList::const_iterator it = scores.begin(); it != scores.end(); ++it)
+	{
+		if ((*it).id() == 0)
+			scoreA = (*it).score();
+		else
+			scoreB = (*it).score();
+	}
+
+	out << "@game " << index << " " << scoreA << " " << scoreB << " " << turn << endl;
+}
+
+// How many of the games begin to end (exclusive) shard file fileName
+// holds, or -1 if it can't be read.
+static int shardGames(const QString &fileName, unsigned int begin, unsigned int end)
+{
+	QFile shardFile(fileName);
+	if (!shardFile.open(QIODevice::ReadOnly | QIODevice::Text))
+		return -1;
+
+	int ret = 0;
+	QTextStream in(&shardFile);
+	while (!in.atEnd())
+	{
+		const QStringList fields = in.readLine().split(' ');
+		if (fields.size() < 4 || fields[0] != "@game")
+			continue;
+
+		const unsigned int index = fields[1].toUInt();
+		if (index >= begin && index < end)
+			++ret;
+	}
+
+	return ret;
+}
+
+void TestHarness::tournament(unsigned int seed, unsigned int reps, int workers, unsigned int shardSize, const QString &outputDirectory, bool playability)
+{
+	if (seed == numeric_limits<unsigned int>::max())
+		seed = QDateTime::currentDateTime().toTime_t();
+	if (workers < 1)
+		workers = QThread::idealThreadCount();
+	if (shardSize < 1)
+		shardSize = 1;
+
+	QDir dir(outputDirectory);
+	if (!QDir::current().mkpath(outputDirectory))
+	{
+		UVcout << "Could not make tournament directory " << QuackleIO::Util::qstringToString(outputDirectory) << endl;
+		return;
+	}
+
+	// A run picks up an earlier one only if it plays the same games.
+	// The number of games may differ, so shards are checked for the
+	// games they hold before they are skipped.
+	const QString description = QString("seed %1 shard %2 players %3 / %4 playability %5\n")
+		.arg(seed).arg(shardSize)
+		.arg(QuackleIO::Util::uvStringToQString(m_computerPlayerToTest->name()))
+		.arg(QuackleIO::Util::uvStringToQString(m_computerPlayer2ToTest->name()))
+		.arg(playability);
+
+	QFile checkpoint(dir.filePath("tournament.txt"));
+	if (checkpoint.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		const QString earlier = QTextStream(&checkpoint).readAll();
+		checkpoint.close();
+		if (earlier != description)
+		{
+			UVcout << "Tournament directory " << QuackleIO::Util::qstringToString(outputDirectory) << " holds a different tournament: " << QuackleIO::Util::qstringToString(earlier) << endl;
+			return;
+		}
+	}
+	else
+	{
+		if (!checkpoint.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			UVcout << "Could not write " << QuackleIO::Util::qstringToString(checkpoint.fileName()) << endl;
+			return;
+		}
+		QTextStream(&checkpoint) << description;
+		checkpoint.close();
+	}
+
+	const unsigned int shards = (reps + shardSize - 1) / shardSize;
+	UVcout << "tournament: " << reps << " games with seed " << seed << " in " << shards << " shards on " << workers << " threads" << endl;
+
+	atomic<unsigned int> nextShard(0);
+	mutex outputMutex;
+
+	// Each worker plays whole shards with its own copies of the
+	// players, and writes each shard under a temporary name that
+	// is only given its real one once the shard is complete.
+	auto work = [&]()
+	{
+		DataManagerScope scope(&m_dataManager);
+
+		ComputerPlayer *playerA = m_computerPlayerToTest->clone();
+		ComputerPlayer *playerB = m_computerPlayer2ToTest->clone();
+
+		// the workers share the cores between them
+		for (ComputerPlayer *player : { playerA, playerB })
+		{
+			ComputerParameters parameters = player->parameters();
+			parameters.threadCount = max(1, QThread::idealThreadCount() / workers);
+			player->setParameters(parameters);
+		}
+
+		for (unsigned int shard = nextShard++; shard < shards; shard = nextShard++)
+		{
+			const QString shardName = dir.filePath(QString("shard-%1.txt").arg(shard, 6, 10, QChar('0')));
+			const unsigned int begin = shard * shardSize;
+			const unsigned int end = min(reps, (shard + 1) * shardSize);
+
+			// a last shard left short by a run with fewer games
+			// is played again in full
+			if (shardGames(shardName, begin, end) == static_cast<int>(end - begin))
+				continue;
+
+			UVOStringStream out;
+			for (unsigned int index = begin; index < end; ++index)
+				playTournamentGame(playerA, playerB, seed, index, playability, out);
+
+			QFile partFile(shardName + ".part");
+			if (!partFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+			{
+				lock_guard<mutex> lock(outputMutex);
+				UVcout << "could not write shard " << shard << " to " << QuackleIO::Util::qstringToString(partFile.fileName()) << endl;
+				continue;
+			}
+			QTextStream partStream(&partFile);
+			partStream << QuackleIO::Util::uvStringToQString(out.str());
+			partStream.flush();
+			partFile.close();
+
+			lock_guard<mutex> lock(outputMutex);
+			QFile::remove(shardName);
+			if (QFile::rename(partFile.fileName(), shardName))
+				UVcout << "finished shard " << shard << endl;
+			else
+				UVcout << "could not write shard " << shard << endl;
+		}
+
+		delete playerA;
+		delete playerB;
+	};
+
+	vector<thread> threads;
+	for (int i = 1; i < workers; ++i)
+		threads.push_back(thread(work));
+
+	work();
+
+	for (auto &it : threads)
+		it.join();
+
+	// statistics of the games of every finished shard, from A's side
+	AveragedValue spread;
+	AveragedValue wins;
+	int draws = 0;
+
+	for (unsigned int shard = 0; shard < shards; ++shard)
+	{
+		QFile shardFile(dir.filePath(QString("shard-%1.txt").arg(shard, 6, 10, QChar('0'))));
+		if (!shardFile.open(QIODevice::ReadOnly | QIODevice::Text))
+			continue;
+
+		QTextStream in(&shardFile);
+		while (!in.atEnd())
+		{
+			const QStringList fields = in.readLine().split(' ');
+			if (fields.size() < 4 || fields[0] != "@game" || fields[1].toUInt() >= reps)
+				continue;
+
+			const int difference = fields[2].toInt() - fields[3].toInt();
+			spread.incorporateValue(difference);
+			wins.incorporateValue(difference > 0? 1 : difference == 0? 0.5 : 0);
+			if (difference == 0)
+				++draws;
+		}
+	}
+
+	if (!wins.hasValues())
+		return;
+
+	// half widths of 95% confidence intervals
+	const double games = wins.incorporatedValues();
+	const double winsInterval = 1.96 * wins.standardDeviation() / sqrt(games);
+	const double spreadInterval = 1.96 * spread.standardDeviation() / sqrt(games);
+
+	UVcout << "games: " << wins.incorporatedValues() << ", draws: " << draws << endl;
+	UVcout << m_computerPlayerToTest->name() << " (A) win rate against " << m_computerPlayer2ToTest->name() << " (B): "
+	       << wins.averagedValue() * 100 << "% +/- " << winsInterval * 100 << "%" << endl;
+	UVcout << "mean spread of A: " << spread.averagedValue() << " +/- " << spreadInterval
+	       << " (standard deviation " << spread.standardDeviation() << ")" << endl;
+
+	// of the games played this run
+	const ResultCache *cache = m_dataManager.resultCache();
+	const long lookups = cache->lookups();
+	UVcout << "result cache: " << cache->hits() << " hits in " << lookups << " lookups ("
+	       << (lookups > 0? 100.0 * cache->hits() / lookups : 0) << "%), "
+	       << cache->size() << " of " << cache->capacity() << " entries in use" << endl;
+}
+
 static void dumpGaddag(const GaddagNode *node, const LetterString &prefix)
 {
     for (const GaddagNode* child = node->firstChild(); child; child = child->nextSibling()) {
@@ -899,3 +1197,395 @@ void TestHarness::wordDump()
 	UVcout << "wordDump: no gaddag" << endl;
     }
 }
+
+// starts a game between two computer players, A and B
+static void startStaticGame(Quackle::Game &game)
+{
+	Quackle::PlayerList players;
+	players.push_back(Quackle::Player(MARK_UV("A"), Quackle::Player::ComputerPlayerType, 0));
+	players.push_back(Quackle::Player(MARK_UV("B"), Quackle::Player::ComputerPlayerType, 1));
+	game.setPlayers(players);
+	game.addPosition();
+}
+
+void TestHarness::playStaticGames(unsigned int seed, unsigned int reps, vector<Quackle::GamePosition> &positions, vector<Quackle::Move> &moves)
+{
+	if (seed != numeric_limits<unsigned int>::max())
+		m_dataManager.seedRandomNumbers(seed);
+
+	for (unsigned int i = 0; i < reps; ++i)
+	{
+		Quackle::Game game;
+		startStaticGame(game);
+
+		while (!game.currentPosition().gameOver())
+		{
+			const Quackle::Move move = game.currentPosition().staticBestMove();
+			positions.push_back(game.currentPosition());
+			moves.push_back(move);
+			game.commitMove(move);
+		}
+	}
+}
+
+// true if both boards have the same tiles, cross sets and cross scores
+static bool sameBoards(const Quackle::Board &board1, const Quackle::Board &board2)
+{
+	if (board1.width() != board2.width() || board1.height() != board2.height())
+		return false;
+
+	for (int row = 0; row < board1.height(); ++row)
+	{
+		for (int col = 0; col < board1.width(); ++col)
+		{
+			if (board1.letter(row, col) != board2.letter(row, col) || board1.isBlank(row, col) != board2.isBlank(row, col))
+				return false;
+			if (board1.vcross(row, col) != board2.vcross(row, col) || board1.hcross(row, col) != board2.hcross(row, col))
+				return false;
+			if (board1.vcrossScore(row, col) != board2.vcrossScore(row, col) || board1.hcrossScore(row, col) != board2.hcrossScore(row, col))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void TestHarness::commitBenchmark(unsigned int seed, unsigned int reps)
+{
+	vector<Quackle::GamePosition> positions;
+	vector<Quackle::Move> moves;
+	playStaticGames(seed, reps, positions, moves);
+
+	const int passes = 10;
+	const double plies = static_cast<double>(positions.size()) * passes;
+	UVcout << "commitbench: " << positions.size() << " plies from " << reps << " games, " << passes << " passes" << endl;
+
+	// both paths must leave the same board behind
+	int mismatches = 0;
+	for (unsigned int i = 0; i < positions.size(); ++i)
+	{
+		Quackle::GamePosition copied(positions[i]);
+		Quackle::Generator generator(copied);
+		generator.makeMove(moves[i], true);
+
+		Quackle::GamePosition inPlace(positions[i]);
+		inPlace.makeMove(moves[i]);
+
+		if (!sameBoards(generator.position().board(), inPlace.board()))
+		{
+			++mismatches;
+			UVcout << "MISMATCH after " << moves[i] << " on:" << endl << positions[i] << endl;
+		}
+	}
+	UVcout << "commitbench: " << mismatches << " plies whose boards or cross sets differ between the paths" << endl;
+
+	// every timing includes copying the position to commit onto
+	QElapsedTimer timer;
+	timer.start();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (unsigned int i = 0; i < positions.size(); ++i)
+		{
+			Quackle::GamePosition scratch(positions[i]);
+		}
+	}
+	const double copyNanoseconds = timer.nsecsElapsed() / plies;
+
+	// the old path: commit through a Generator holding a copy
+	// of the position, then copy its board back
+	timer.restart();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (unsigned int i = 0; i < positions.size(); ++i)
+		{
+			Quackle::GamePosition scratch(positions[i]);
+			Quackle::Generator generator(scratch);
+			generator.makeMove(moves[i], true);
+			scratch.underlyingBoardReference() = generator.position().board();
+		}
+	}
+	const double generatorNanoseconds = timer.nsecsElapsed() / plies;
+
+	timer.restart();
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (unsigned int i = 0; i < positions.size(); ++i)
+		{
+			Quackle::GamePosition scratch(positions[i]);
+			scratch.makeMove(moves[i]);
+		}
+	}
+	const double inPlaceNanoseconds = timer.nsecsElapsed() / plies;
+
+	UVcout << "position copy:       " << copyNanoseconds << " ns/ply" << endl;
+	UVcout << "generator copy path: " << generatorNanoseconds - copyNanoseconds << " ns/ply" << endl;
+	UVcout << "in-place path:       " << inPlaceNanoseconds - copyNanoseconds << " ns/ply" << endl;
+}
+
+// true if both positions have the same board, racks, scores, bag,
+// turn and moves
+static bool samePositions(const Quackle::GamePosition &position1, const Quackle::GamePosition &position2)
+{
+	if (!sameBoards(position1.board(), position2.board()))
+		return false;
+
+	if (position1.players().size() != position2.players().size())
+		return false;
+
+	for (unsigned int i = 0; i < position1.players().size(); ++i)
+	{
+		const Quackle::Player &player1 = position1.players()[i];
+		const Quackle::Player &player2 = position2.players()[i];
+		if (player1.rack().tiles() != player2.rack().tiles() || player1.score() != player2.score())
+			return false;
+		if (player1.drawnLetters().tiles() != player2.drawnLetters().tiles())
+			return false;
+	}
+
+	return position1.currentPlayer().id() == position2.currentPlayer().id()
+		&& position1.turnNumber() == position2.turnNumber()
+		&& position1.scorelessTurnsInARow() == position2.scorelessTurnsInARow()
+		&& position1.gameOver() == position2.gameOver()
+		&& position1.bag().toString() == position2.bag().toString()
+		&& position1.moves().size() == position2.moves().size();
+}
+
+void TestHarness::playoutCheck(unsigned int seed, unsigned int reps)
+{
+	if (seed != numeric_limits<unsigned int>::max())
+		m_dataManager.seedRandomNumbers(seed);
+
+	const int candidates = 5;
+	const int plies = 4;
+
+	int checked = 0;
+	int mismatches = 0;
+
+	for (unsigned int i = 0; i < reps; ++i)
+	{
+		Quackle::Game game;
+		startStaticGame(game);
+
+		while (!game.currentPosition().gameOver())
+		{
+			Quackle::GamePosition position(game.currentPosition());
+			position.kibitz(candidates);
+			const Quackle::MoveList moves = position.moves();
+
+			// one playout is rewound between candidates, as in a sim
+			Quackle::GamePosition playedOut(position);
+			Quackle::Playout playout;
+			playout.start(&playedOut, game.history());
+
+			for (const auto &candidate : moves)
+			{
+				playout.rewind();
+				if (!samePositions(playedOut, position))
+				{
+					++mismatches;
+					UVcout << "MISMATCH after rewinding from " << candidate << " on:" << endl << position << endl;
+				}
+
+				// both paths draw from the same stream
+				Quackle::RandomStreamScope streamScope;
+				const Quackle::RandomGenerator stream(++checked);
+
+				// the old path: a copy of the game for every candidate
+				m_dataManager.setThreadRandomGenerator(stream);
+				Quackle::Game copied(game);
+				vector<Quackle::GamePosition> expected;
+				copied.commitMove(candidate);
+				expected.push_back(copied.currentPosition());
+				for (int ply = 1; ply < plies && !copied.currentPosition().gameOver(); ++ply)
+				{
+					copied.commitMove(copied.currentPosition().staticBestMove());
+					expected.push_back(copied.currentPosition());
+				}
+
+				m_dataManager.setThreadRandomGenerator(stream);
+				playout.commitMove(candidate);
+				for (unsigned int ply = 0; ply < expected.size(); ++ply)
+				{
+					if (ply > 0)
+						playout.commitMove(playedOut.staticBestMove());
+
+					if (!samePositions(playedOut, expected[ply]))
+					{
+						++mismatches;
+						UVcout << "MISMATCH at ply " << ply << " after " << candidate << " on:" << endl << position << endl;
+						break;
+					}
+				}
+			}
+
+			game.commitMove(game.currentPosition().staticBestMove());
+		}
+	}
+
+	UVcout << "playoutcheck: " << checked << " candidates played out " << plies << " plies, " << mismatches << " mismatches" << endl;
+}
+
+void TestHarness::movegenBenchmark(unsigned int seed, unsigned int reps)
+{
+	vector<Quackle::GamePosition> positions;
+	vector<Quackle::Move> moves;
+	playStaticGames(seed, reps, positions, moves);
+
+	const int passes = 10;
+	const double count = static_cast<double>(positions.size()) * passes;
+	UVcout << "movegenbench: " << positions.size() << " positions from " << reps << " games, " << passes << " passes, "
+	       << (QUACKLE_LEXICON_PARAMETERS->hasGaddag()? "gaddag" : "dawg only") << endl;
+
+	qint64 generateNanoseconds = 0;
+	qint64 crossNanoseconds = 0;
+	QElapsedTimer timer;
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (unsigned int i = 0; i < positions.size(); ++i)
+		{
+			Quackle::GamePosition scratch(positions[i]);
+
+			timer.start();
+			scratch.kibitz(1);
+			generateNanoseconds += timer.nsecsElapsed();
+
+			timer.start();
+			scratch.ensureBoardIsPreparedForAnalysis();
+			crossNanoseconds += timer.nsecsElapsed();
+		}
+	}
+
+	UVcout << "best move:  " << generateNanoseconds / count / 1000 << " us/position" << endl;
+	UVcout << "cross sets: " << crossNanoseconds / count / 1000 << " us/position" << endl;
+
+	Quackle::CrossCache *cache = QUACKLE_LEXICON_PARAMETERS->crossCache();
+	UVcout << "cross cache: " << cache->hits() << " hits, " << cache->misses() << " misses, " << cache->size() << " entries" << endl;
+}
+
+// Value to the player to move of an endgame position, found by
+// trying every play and a pass to the end of the game, with the
+// game itself deciding when that is and what is left on racks costs.
+// Values are remembered by board, racks, player to move and
+// scoreless turns before.
+static int bruteForceEndgame(const Quackle::GamePosition &position, map<string, int> &values)
+{
+	string key;
+	const Quackle::Board &board = position.board();
+	for (int row = 0; row < board.height(); ++row)
+		for (int col = 0; col < board.width(); ++col)
+			key += static_cast<char>(board.letter(row, col) | (board.isBlank(row, col) << 7));
+	for (const auto &it : position.players())
+	{
+		const Quackle::LetterString tiles = it.rack().alphaTiles();
+		key += '/';
+		for (unsigned int i = 0; i < tiles.length(); ++i)
+			key += static_cast<char>(tiles[i]);
+	}
+	key += static_cast<char>(position.currentPlayer().id());
+	key += static_cast<char>(position.scorelessTurnsInARow());
+
+	const map<string, int>::const_iterator found = values.find(key);
+	if (found != values.end())
+		return found->second;
+
+	Quackle::Generator generator(position);
+	generator.kibitz(numeric_limits<int>::max(), Quackle::Generator::CannotExchange);
+	Quackle::MoveList moves = generator.kibitzList();
+	if (!moves.contains(Quackle::Move::createPassMove()))
+		moves.push_back(Quackle::Move::createPassMove());
+
+	const int mover = position.currentPlayer().id();
+	int best = numeric_limits<int>::min();
+	for (const auto &move : moves)
+	{
+		Quackle::GamePosition child(position);
+		child.setMoveMade(move);
+		child.incrementTurn(NULL);
+		child.makeMove(move);
+
+		// spreads count what is left on racks once the game is over
+		int value = child.spread(mover) - position.spread(mover);
+		if (!child.gameOver())
+			value -= bruteForceEndgame(child, values);
+
+		best = max(best, value);
+	}
+
+	values[key] = best;
+	return best;
+}
+
+void TestHarness::endgameCheck(unsigned int seed, unsigned int reps)
+{
+	vector<Quackle::GamePosition> positions;
+	vector<Quackle::Move> moves;
+	playStaticGames(seed, reps, positions, moves);
+
+	// small enough for brute force to take seconds at most
+	const int maximumTiles = 5;
+
+	Quackle::GameParameters *parameters = m_dataManager.parameters();
+	const int scorelessTurnLimit = parameters->numberOfScorelessTurnsThatEndsGame();
+
+	int checked = 0;
+	int mismatches = 0;
+
+	// with the game's limit on scoreless turns and with passes
+	// mattering more, under a limit of two
+	const int limits[] = { scorelessTurnLimit, 2 };
+	for (const int limit : limits)
+	{
+		parameters->setNumberOfScorelessTurnsThatEndsGame(limit);
+
+		for (const auto &position : positions)
+		{
+			if (!Quackle::EndgameSolver::canSolve(position))
+				continue;
+
+			int tiles = 0;
+			for (const auto &it : position.players())
+				tiles += it.rack().size();
+			if (tiles > maximumTiles)
+				continue;
+
+			Quackle::EndgameSolver solver;
+			solver.setPosition(position);
+			const Quackle::MoveList solved = solver.solve(3);
+
+			map<string, int> values;
+			const int mover = position.currentPlayer().id();
+
+			// each play the solver returns should be worth what it says
+			bool match = solver.isExact();
+			for (const auto &move : solved)
+			{
+				Quackle::GamePosition child(position);
+				child.setMoveMade(move);
+				child.incrementTurn(NULL);
+				child.makeMove(move);
+
+				int value = child.spread(mover) - position.spread(mover);
+				if (!child.gameOver())
+					value -= bruteForceEndgame(child, values);
+
+				match = match && value == static_cast<int>(move.equity);
+			}
+
+			const int best = bruteForceEndgame(position, values);
+			match = match && !solved.empty() && best == static_cast<int>(solved.front().equity);
+
+			++checked;
+			if (!match)
+			{
+				++mismatches;
+				UVcout << "MISMATCH with " << limit << " scoreless turns ending the game, brute force " << best << ":" << endl;
+				UVcout << position << endl;
+				UVcout << solved << endl;
+			}
+		}
+	}
+
+	parameters->setNumberOfScorelessTurnsThatEndsGame(scorelessTurnLimit);
+
+	UVcout << "endgamecheck: " << checked << " endgames of at most " << maximumTiles << " tiles, " << mismatches << " mismatches" << endl;
+}
@@ -23,6 +23,8 @@
 
 #include <QStringList>
 
+#include <vector>
+
 #include <datamanager.h>
 #include <alphabetparameters.h>
 namespace Quackle
@@ -30,6 +32,7 @@ namespace Quackle
 	class ComputerPlayer;
 	class Game;
 	class GamePosition;
+	class Move;
 	class Rack;
 	class GaddagNode;
 }
@@ -81,12 +84,37 @@ public:
 
 	void wordDump();
 
+	// Plays static games and times committing each of their moves
+	// to the board, through a Generator copy and in place.
+	void commitBenchmark(unsigned int seed, unsigned int reps);
+
+	// Times static move generation and cross set computation on the
+	// positions of static games.
+	void movegenBenchmark(unsigned int seed, unsigned int reps);
+
+	// Solves the small endgames of static games with EndgameSolver
+	// and by brute force, and reports any that disagree.
+	void endgameCheck(unsigned int seed, unsigned int reps);
+
+	// Plays out candidates of static games' positions in place with
+	// Playout and on copies of the Game, and reports any that differ.
+	void playoutCheck(unsigned int seed, unsigned int reps);
+
 	// Allocates and loads a game from the file.
 	Quackle::Game *createNewGame(const QString &filename);
 
 	void selfPlayGames(unsigned int seed, unsigned int reps, bool reports, bool playability);
 	void selfPlayGame(unsigned int gameNumber, bool reports, bool playability);
 
+	// Plays reps selfplay games on workers threads (one per core if
+	// less than one). Game i draws from a random stream of its own
+	// off seed, so which thread plays it makes no difference. Games
+	// are written in shards of shardSize to outputDirectory, and
+	// shards found there already are not played again, so that an
+	// interrupted tournament picks up where it stopped. Prints win
+	// rate and spread, with 95% confidence intervals, over all shards.
+	void tournament(unsigned int seed, unsigned int reps, int workers, unsigned int shardSize, const QString &outputDirectory, bool playability);
+
 	// Sets the positions that will be tested.
 	void setPositions(const QStringList &positions)
 	{
@@ -104,6 +132,15 @@ public:
 	}
 
 protected:
+	// Plays reps games of static moves, collecting each position
+	// and the move made from it.
+	void playStaticGames(unsigned int seed, unsigned int reps, vector<Quackle::GamePosition> &positions, vector<Quackle::Move> &moves);
+
+	// Plays game index of a tournament, A and B taking turns going
+	// first, writing playability output if asked and then a line
+	// "@game index scoreA scoreB turns" to out.
+	void playTournamentGame(Quackle::ComputerPlayer *playerA, Quackle::ComputerPlayer *playerB, unsigned int seed, unsigned int index, bool playability, UVOStream &out);
+
     //	void dumpGaddag(const GaddagNode *node, const LetterString &prefix);
 	QStringList m_positions;
 	Quackle::DataManager m_dataManager;